@@ -0,0 +1,121 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "bot_api/connection.h"
+#include "bot_api/connector.h"
+#include "core/bench_boards.h"
+#include "core/board.h"
+#include "core/init.h"
+#include "search/search.h"
+
+using namespace std::chrono_literals;
+
+using SoFBotApi::ApiResult;
+using SoFBotApi::Client;
+using SoFBotApi::PollResult;
+using std::chrono::steady_clock;
+
+// Server that ignores everything except `finishSearch()` and records the time when it was called
+class LatencyServer final : public SoFBotApi::ServerConnector {
+public:
+  ApiResult finishSearch(SoFCore::Move, SoFCore::Move) override {
+    {
+      std::unique_lock lock(lock_);
+      finishTime_ = steady_clock::now();
+    }
+    finished_.notify_all();
+    return ApiResult::Ok;
+  }
+
+  ApiResult sendString(const char *) override { return ApiResult::Ok; }
+  ApiResult sendResult(const SoFBotApi::SearchResult &) override { return ApiResult::Ok; }
+  ApiResult sendNodeCount(uint64_t) override { return ApiResult::Ok; }
+  ApiResult sendHashHits(uint64_t) override { return ApiResult::Ok; }
+  ApiResult sendHashFull(SoFBotApi::permille_t) override { return ApiResult::Ok; }
+  ApiResult sendCurrMove(SoFCore::Move, size_t) override { return ApiResult::Ok; }
+  ApiResult reportError(const char *) override { return ApiResult::Ok; }
+
+  PollResult poll() override { return PollResult::NoData; }
+
+  // Forgets about the previous finished search
+  inline void reset() {
+    std::unique_lock lock(lock_);
+    finishTime_.reset();
+  }
+
+  // Waits until the search is finished and returns the time when it happened
+  inline steady_clock::time_point waitFinish() {
+    std::unique_lock lock(lock_);
+    finished_.wait(lock, [&]() { return finishTime_.has_value(); });
+    return *finishTime_;
+  }
+
+protected:
+  ApiResult connect(Client *) override { return ApiResult::Ok; }
+  void disconnect() override {}
+
+private:
+  std::mutex lock_;
+  std::condition_variable finished_;
+  std::optional<steady_clock::time_point> finishTime_;
+};
+
+// Time for which the search runs before we try to stop it
+constexpr auto SEARCH_TIME = 30ms;
+
+// Number of stops performed in each benchmark
+constexpr size_t STOP_COUNT = 100;
+
+static void BM_StopLatency(benchmark::State &state) {
+  SoFCore::init();
+
+  auto engineHolder = std::make_unique<SoFSearch::Engine>();
+  auto serverHolder = std::make_unique<LatencyServer>();
+  SoFSearch::Engine &engine = *engineHolder;
+  LatencyServer &server = *serverHolder;
+  auto connection =
+      SoFBotApi::Connection::clientSide(std::move(engineHolder), std::move(serverHolder)).unwrap();
+
+  engine.options().setInt("Threads", state.range(0));
+  engine.setPosition(SoFCore::Board::fromFen(g_fenMiddle).unwrap(), nullptr, 0);
+
+  std::vector<double> latencies;
+  for ([[maybe_unused]] auto _ : state) {
+    server.reset();
+    engine.searchInfinite();
+    std::this_thread::sleep_for(SEARCH_TIME);
+    const auto stopTime = steady_clock::now();
+    engine.stopSearch();
+    const auto finishTime = server.waitFinish();
+    const double latency = std::chrono::duration<double>(finishTime - stopTime).count();
+    state.SetIterationTime(latency);
+    latencies.push_back(latency);
+  }
+
+  // Report the percentiles in microseconds
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&](const size_t p) {
+    return latencies[std::min(latencies.size() - 1, latencies.size() * p / 100)] * 1e6;
+  };
+  state.counters["p50_us"] = percentile(50);
+  state.counters["p90_us"] = percentile(90);
+  state.counters["p99_us"] = percentile(99);
+  state.counters["max_us"] = latencies.back() * 1e6;
+}
+
+BENCHMARK(BM_StopLatency)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->Iterations(STOP_COUNT)
+    ->UseManualTime()
+    ->Unit(benchmark::kMicrosecond);
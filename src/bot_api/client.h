@@ -11,8 +11,7 @@
 
 namespace SoFBotApi {
 
-// TODO : add API for ponder
-// TODO : add API for "go" subcommands: "searchmoves", "mate"
+// TODO : add API for "go" subcommands: "searchmoves"
 
 class Server;
 class Options;
@@ -81,6 +80,9 @@ public:
     return ApiResult::NotSupported;
   }
 
+  // Search for checkmate in at most `moves` moves. The search stops when such checkmate is found
+  virtual ApiResult searchMate([[maybe_unused]] size_t moves) { return ApiResult::NotSupported; }
+
   // Search for fixed amount of time
   virtual ApiResult searchFixedTime([[maybe_unused]] std::chrono::milliseconds time) {
     return ApiResult::NotSupported;
@@ -89,6 +91,16 @@ public:
   // Search with given time control
   virtual ApiResult searchTimeControl(const TimeControl &control) = 0;
 
+  // Enable ponder mode for the next search started by one of the `search...()` methods. In ponder
+  // mode, the engine searches the position after the expected opponent's move. It must not apply
+  // the time limits and must not finish the search by itself until `ponderHit()` or `stopSearch()`
+  // is called
+  virtual ApiResult enablePonder() { return ApiResult::NotSupported; }
+
+  // Indicate that the opponent made the expected move. The running search must leave ponder mode
+  // and continue as a normal search, with the time limits counted from this moment
+  virtual ApiResult ponderHit() { return ApiResult::NotSupported; }
+
   // Stop search and report best move via `finishSearch()` server call
   virtual ApiResult stopSearch() = 0;
 
@@ -55,6 +55,11 @@ public:
     return ApiResult::NotSupported;
   }
 
+  ApiResult searchMate(size_t moves) override {
+    cerr << "searchMate(" << moves << ")" << endl;
+    return ApiResult::Ok;
+  }
+
   ApiResult searchFixedTime(std::chrono::milliseconds time) override {
     cerr << "searchFixedTime(" << time.count() << ")" << endl;
     std::vector<SoFCore::Move> moves{SoFCore::Move{SoFCore::MoveKind::PawnDoubleMove, 52, 36, 0}};
@@ -82,6 +87,16 @@ public:
     return ApiResult::Ok;
   }
 
+  ApiResult enablePonder() override {
+    cerr << "enablePonder()" << endl;
+    return ApiResult::Ok;
+  }
+
+  ApiResult ponderHit() override {
+    cerr << "ponderHit()" << endl;
+    return ApiResult::Ok;
+  }
+
   ApiResult setPosition(const SoFCore::Board &board, const SoFCore::Move *moves,
                         size_t count) override {
     cerr << "setPosition(" << board.asFen();
@@ -98,7 +113,8 @@ public:
     // server_->sendNodeCount(42'000'000);
     server_->sendString(":)");
     server_->sendHashFull(500);
-    server_->finishSearch(SoFCore::Move{SoFCore::MoveKind::PawnDoubleMove, 52, 36, 0});
+    server_->finishSearch(SoFCore::Move{SoFCore::MoveKind::PawnDoubleMove, 52, 36, 0},
+                          SoFCore::Move::null());
     return ApiResult::Ok;
   }
 
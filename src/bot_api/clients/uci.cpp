@@ -62,13 +62,17 @@ void UciServerConnector::ensureClient() {
   }
 }
 
-ApiResult UciServerConnector::finishSearch(const Move bestMove) {
+ApiResult UciServerConnector::finishSearch(const Move bestMove, const Move ponderMove) {
   ensureClient();
   std::lock_guard guard(mutex_);
   if (!searchStarted_) {
     return ApiResult::UnexpectedCall;
   }
-  D_CHECK_IO(out_ << "bestmove " << moveToStr(bestMove) << endl);
+  D_CHECK_IO(out_ << "bestmove " << moveToStr(bestMove));
+  if (ponderMove != Move::null()) {
+    D_CHECK_IO(out_ << " ponder " << moveToStr(ponderMove));
+  }
+  D_CHECK_IO(out_ << endl);
   searchStarted_ = false;
   return ApiResult::Ok;
 }
@@ -159,7 +163,11 @@ ApiResult UciServerConnector::sendResult(const SearchResult &result) {
     return ApiResult::UnexpectedCall;
   }
   const uint64_t timeMsec = duration_cast<milliseconds>(getSearchTime()).count();
-  D_CHECK_IO(out_ << "info depth " << result.depth << " time " << timeMsec);
+  D_CHECK_IO(out_ << "info depth " << result.depth);
+  if (result.multipv != 0) {
+    D_CHECK_IO(out_ << " multipv " << result.multipv);
+  }
+  D_CHECK_IO(out_ << " time " << timeMsec);
   if (result.pvLen != 0) {
     D_CHECK_IO(out_ << " pv");
     for (size_t i = 0; i < result.pvLen; ++i) {
@@ -252,12 +260,31 @@ bool UciServerConnector::tryReadMsec(milliseconds &time, std::istream &stream) {
   return true;
 }
 
-PollResult UciServerConnector::processUciGo(std::istream &tokens) {
+PollResult UciServerConnector::processUciGo(std::istream &cmdTokens) {
   if (searchStarted_) {
     logError(UCI_SERVER) << "Search is already started";
     return PollResult::NoData;
   }
 
+  // Ponder mode applies to any kind of search, so we need to enable it before starting the search.
+  // Thus, we look for "ponder" subcommand first, and only then parse the remaining ones
+  string args;
+  std::getline(cmdTokens, args);
+  {
+    std::istringstream scanner(args);
+    string token;
+    while (scanner >> token) {
+      if (token == "ponder") {
+        const ApiResult result = checkClient(client_->enablePonder());
+        if (result != ApiResult::Ok) {
+          return doStartSearch(result);
+        }
+        break;
+      }
+    }
+  }
+  std::istringstream tokens(args);
+
   // List of supported subcommands
   const vector<string> subcommands{"searchmoves", "ponder", "wtime",     "btime",
                                    "winc",        "binc",   "movestogo", "depth",
@@ -298,7 +325,7 @@ PollResult UciServerConnector::processUciGo(std::istream &tokens) {
       continue;
     }
     if (token == "ponder") {
-      // Not supported.
+      // Already processed above.
       continue;
     }
     if (token == "wtime") {
@@ -338,10 +365,12 @@ PollResult UciServerConnector::processUciGo(std::istream &tokens) {
       return doStartSearch(client_->searchFixedNodes(val));
     }
     if (token == "mate") {
-      // Not supported.
-      string unused;
-      tokens >> unused;
-      continue;
+      // Search for checkmate.
+      size_t val;
+      if (!tryReadInt(val, tokens, "size_t")) {
+        continue;
+      }
+      return doStartSearch(client_->searchMate(val));
     }
     if (token == "movetime") {
       milliseconds val;
@@ -684,8 +713,12 @@ PollResult UciServerConnector::processUciCommand(std::istream &tokens) {
       return PollResult::Ok;
     }
     if (command == "ponderhit") {
-      // Not supported.
-      return PollResult::NoData;
+      if (!searchStarted_) {
+        logError(UCI_SERVER) << "Cannot process ponderhit, as the search is not started";
+        return PollResult::NoData;
+      }
+      checkClient(client_->ponderHit());
+      return PollResult::Ok;
     }
     if (command == "quit") {
       logInfo(UCI_SERVER) << "Stopping.";
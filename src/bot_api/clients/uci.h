@@ -30,7 +30,7 @@ public:
   const char *name() const override { return "UCI Server Connector"; }
   const char *author() const override { return "SoFCheck developers"; }
 
-  ApiResult finishSearch(SoFCore::Move bestMove) override;
+  ApiResult finishSearch(SoFCore::Move bestMove, SoFCore::Move ponderMove) override;
   ApiResult sendString(const char *str) override;
   ApiResult sendResult(const SearchResult &result) override;
   ApiResult sendNodeCount(uint64_t nodes) override;
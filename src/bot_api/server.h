@@ -40,10 +40,11 @@ public:
 
   // Indicate that the client finished the search, reporting the best move to the server. The client
   // must call this method after `stop()`, `disconnect()` (if the search was running at this time)
-  // or when it stops the search itself
+  // or when it stops the search itself. `ponderMove` is the expected reply to the best move, on
+  // which the server may start pondering, or null move if it's unknown
   //
   // Note that the search is considered finished only if the function returns without errors
-  virtual ApiResult finishSearch(SoFCore::Move bestMove) = 0;
+  virtual ApiResult finishSearch(SoFCore::Move bestMove, SoFCore::Move ponderMove) = 0;
 
   // Send an arbitrary string message to the server
   virtual ApiResult sendString(const char *str) = 0;
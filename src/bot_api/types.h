@@ -121,6 +121,7 @@ struct SearchResult {
   size_t pvLen;             // Length of the best line found (if not present, set to zero)
   PositionCost cost;        // Estimated position cost
   PositionCostBound bound;  // Is position cost exact?
+  size_t multipv = 0;       // Index of the line in multi-PV mode (starting from 1), or zero
 };
 
 }  // namespace SoFBotApi
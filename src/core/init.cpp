@@ -1,19 +1,30 @@
 #include "core/init.h"
 
 #include <atomic>
+#include <cstdint>
 
+#include "core/private/cuckoo.h"
 #include "core/private/magic.h"
 #include "core/private/zobrist.h"
 
 namespace SoFCore {
 
+constexpr uint64_t ZOBRIST_SEED = 0x9e3779b97f4a7c15;
+
 void init() {
   static std::atomic_flag initialized;
   if (initialized.test_and_set()) {
     return;
   }
   Private::initMagic();
-  Private::initZobrist();
+  // Zobrist keys are generated from a fixed seed, so the board hashes are the same on every run and
+  // the search with fixed node count can be reproduced. If the keys don't fit into the cuckoo
+  // table, we just take the next seed
+  uint64_t seed = ZOBRIST_SEED;
+  Private::initZobrist(seed);
+  while (!Private::initCuckoo()) {
+    Private::initZobrist(++seed);
+  }
 }
 
 }  // namespace SoFCore
@@ -1,6 +1,9 @@
 #include "core/movegen.h"
 
+#include <utility>
+
 #include "core/private/bit_consts.h"
+#include "core/private/cuckoo.h"
 #include "core/private/geometry.h"
 #include "core/private/magic.h"
 #include "core/private/near_attacks.h"
@@ -38,6 +41,22 @@ bool isCellAttacked(const SoFCore::Board &b, SoFCore::coord_t coord) {
          (Private::rookAttackBitboard(b.bbAll, coord) & bbLinePieces<C>(b));
 }
 
+bitboard_t cellAttackers(const Board &b, const coord_t coord, const bitboard_t occupied) {
+  const bitboard_t bbKnights = b.bbPieces[makeCell(Color::White, Piece::Knight)] |
+                               b.bbPieces[makeCell(Color::Black, Piece::Knight)];
+  const bitboard_t bbKings = b.bbPieces[makeCell(Color::White, Piece::King)] |
+                             b.bbPieces[makeCell(Color::Black, Piece::King)];
+  const bitboard_t bbDiag = bbDiagPieces<Color::White>(b) | bbDiagPieces<Color::Black>(b);
+  const bitboard_t bbLine = bbLinePieces<Color::White>(b) | bbLinePieces<Color::Black>(b);
+  const bitboard_t attackers =
+      (b.bbPieces[makeCell(Color::White, Piece::Pawn)] & Private::BLACK_PAWN_ATTACKS[coord]) |
+      (b.bbPieces[makeCell(Color::Black, Piece::Pawn)] & Private::WHITE_PAWN_ATTACKS[coord]) |
+      (bbKnights & Private::KNIGHT_ATTACKS[coord]) | (bbKings & Private::KING_ATTACKS[coord]) |
+      (Private::bishopAttackBitboard(occupied, coord) & bbDiag) |
+      (Private::rookAttackBitboard(occupied, coord) & bbLine);
+  return attackers & occupied;
+}
+
 bool isMoveLegal(const Board &b) {
   const Color c = b.side;
   return !isCellAttacked(b, b.kingPos(invert(c)), c);
@@ -337,4 +356,43 @@ bool isMoveValid(const Board &b, const Move move) {
 template bool isCellAttacked<Color::White>(const Board &b, coord_t coord);
 template bool isCellAttacked<Color::Black>(const Board &b, coord_t coord);
 
+bool hasReversibleMove(const Board &b, const board_hash_t hashDiff) {
+  size_t idx = Private::cuckooHash1(hashDiff);
+  if (Private::g_cuckoo[idx].key != hashDiff) {
+    idx = Private::cuckooHash2(hashDiff);
+    if (Private::g_cuckoo[idx].key != hashDiff) {
+      return false;
+    }
+  }
+  const Private::CuckooEntry &entry = Private::g_cuckoo[idx];
+  if (!isCellPieceColorEqualTo(entry.cell, b.side)) {
+    return false;
+  }
+  // The entry describes the move in both directions, so find where the piece is now
+  coord_t src = entry.src;
+  coord_t dst = entry.dst;
+  if (b.cells[src] != entry.cell) {
+    std::swap(src, dst);
+  }
+  if (b.cells[src] != entry.cell || b.cells[dst] != EMPTY_CELL) {
+    return false;
+  }
+  switch (cellPiece(entry.cell)) {
+    case Piece::Bishop: {
+      return bitboardHasBit(Private::bishopAttackBitboard(b.bbAll, src), dst);
+    }
+    case Piece::Rook: {
+      return bitboardHasBit(Private::rookAttackBitboard(b.bbAll, src), dst);
+    }
+    case Piece::Queen: {
+      return bitboardHasBit(
+          Private::bishopAttackBitboard(b.bbAll, src) | Private::rookAttackBitboard(b.bbAll, src),
+          dst);
+    }
+    default: {
+      return true;
+    }
+  }
+}
+
 }  // namespace SoFCore
@@ -19,6 +19,14 @@ inline bool isCellAttacked(const Board &b, const coord_t coord, const Color c) {
                              : isCellAttacked<Color::Black>(b, coord);
 }
 
+// Returns the bitboard of all the pieces of both colors which attack the cell `coord`. Only the
+// pieces from `occupied` are considered, and the sliding pieces are traced as if the occupied cells
+// on the board are exactly `occupied`. This allows to remove the pieces from the board virtually,
+// which is useful to calculate the exchanges on a given cell.
+//
+// Enpassant captures are not considered by this function.
+bitboard_t cellAttackers(const Board &b, coord_t coord, bitboard_t occupied);
+
 // Returns `true` if the last move applied to the board `b` was legal. Note that it doesn't mean
 // that you can apply any illegal moves to the board, the applied move must be still pseudo-legal.
 //
@@ -57,6 +65,13 @@ constexpr size_t BUFSZ_CAPTURES = 128;
 // returned by `genAllMoves()`.
 bool isMoveValid(const Board &b, Move move);
 
+// Returns `true` if the side to move has a reversible move (i.e. a move of a non-pawn piece without
+// capture, castling or promotion) which changes the hash of the board `b` by `hashDiff`. The move
+// is not checked for legality.
+//
+// This is useful to detect that the position is going to repeat one of the previous positions
+bool hasReversibleMove(const Board &b, board_hash_t hashDiff);
+
 // Returns `true` if the move is capture
 inline constexpr bool isMoveCapture(const Board &b, const Move move) {
   return b.cells[move.dst] != EMPTY_CELL || move.kind == MoveKind::Enpassant;
@@ -0,0 +1,85 @@
+#include "core/private/cuckoo.h"
+
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+
+#include "core/private/magic.h"
+#include "core/private/near_attacks.h"
+#include "core/private/zobrist.h"
+#include "util/misc.h"
+
+namespace SoFCore::Private {
+
+CuckooEntry g_cuckoo[CUCKOO_SIZE];
+
+// Number of reversible moves on the empty board for all the non-pawn pieces of both colors
+constexpr size_t REVERSIBLE_MOVE_COUNT = 3668;
+
+// Maximum number of entries evicted while inserting a single move. Longer chains usually mean that
+// the insertion goes in cycles
+constexpr size_t MAX_EVICTIONS = 1024;
+
+static bitboard_t emptyBoardAttacks(const Piece piece, const coord_t src) {
+  switch (piece) {
+    case Piece::King: {
+      return KING_ATTACKS[src];
+    }
+    case Piece::Knight: {
+      return KNIGHT_ATTACKS[src];
+    }
+    case Piece::Bishop: {
+      return bishopAttackBitboard(0, src);
+    }
+    case Piece::Rook: {
+      return rookAttackBitboard(0, src);
+    }
+    case Piece::Queen: {
+      return bishopAttackBitboard(0, src) | rookAttackBitboard(0, src);
+    }
+    default: {
+      return 0;
+    }
+  }
+}
+
+bool initCuckoo() {
+  std::fill(std::begin(g_cuckoo), std::end(g_cuckoo), CuckooEntry{0, EMPTY_CELL, 0, 0});
+  size_t count = 0;
+  for (const Color color : {Color::White, Color::Black}) {
+    for (const Piece piece :
+         {Piece::King, Piece::Knight, Piece::Bishop, Piece::Rook, Piece::Queen}) {
+      const cell_t cell = makeCell(color, piece);
+      for (coord_t src = 0; src < 64; ++src) {
+        const bitboard_t attacks = emptyBoardAttacks(piece, src);
+        for (coord_t dst = src + 1; dst < 64; ++dst) {
+          if (!bitboardHasBit(attacks, dst)) {
+            continue;
+          }
+          // Insert the move, evicting the existing entries to their alternative positions until we
+          // find a free slot
+          CuckooEntry entry{g_zobristPieces[cell][src] ^ g_zobristPieces[cell][dst] ^
+                                g_zobristMoveSide,
+                            cell, src, dst};
+          size_t idx = cuckooHash1(entry.key);
+          for (size_t evictions = 0;; ++evictions) {
+            std::swap(g_cuckoo[idx], entry);
+            if (entry.key == 0) {
+              break;
+            }
+            if (evictions == MAX_EVICTIONS) {
+              return false;
+            }
+            idx = (idx == cuckooHash1(entry.key)) ? cuckooHash2(entry.key) : cuckooHash1(entry.key);
+          }
+          ++count;
+        }
+      }
+    }
+  }
+  SOF_ASSERT(count == REVERSIBLE_MOVE_COUNT);
+  return true;
+}
+
+}  // namespace SoFCore::Private
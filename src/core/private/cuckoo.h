@@ -0,0 +1,38 @@
+#ifndef SOF_CORE_PRIVATE_CUCKOO_INCLUDED
+#define SOF_CORE_PRIVATE_CUCKOO_INCLUDED
+
+#include <cstddef>
+
+#include "core/types.h"
+
+namespace SoFCore::Private {
+
+// Reversible move (i.e. a move of a non-pawn piece without capture) between the cells `src` and
+// `dst` in any direction. `key` is the change of the board hash after such move, or zero if the
+// entry is empty
+struct CuckooEntry {
+  board_hash_t key;
+  cell_t cell;
+  coord_t src;
+  coord_t dst;
+};
+
+// Cuckoo hash table which contains all the reversible moves. Each move is located either in
+// position `cuckooHash1(key)` or in position `cuckooHash2(key)`
+constexpr size_t CUCKOO_SIZE = 8192;
+extern CuckooEntry g_cuckoo[CUCKOO_SIZE];
+
+inline constexpr size_t cuckooHash1(const board_hash_t key) { return key & (CUCKOO_SIZE - 1); }
+
+inline constexpr size_t cuckooHash2(const board_hash_t key) {
+  return (key >> 16) & (CUCKOO_SIZE - 1);
+}
+
+// Fills the cuckoo table. Must be called after `initMagic()` and `initZobrist()`. For rare sets of
+// Zobrist keys, the moves don't fit into the table. Then `false` is returned, and the table must be
+// filled again after generating other Zobrist keys
+bool initCuckoo();
+
+}  // namespace SoFCore::Private
+
+#endif  // SOF_CORE_PRIVATE_CUCKOO_INCLUDED
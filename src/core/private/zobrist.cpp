@@ -1,10 +1,10 @@
 #include "core/private/zobrist.h"
 
 #include <initializer_list>
+#include <random>
 
 #include "core/private/geometry.h"
 #include "core/types.h"
-#include "util/random.h"
 
 namespace SoFCore::Private {
 
@@ -15,23 +15,23 @@ board_hash_t g_zobristEnpassant[64];
 board_hash_t g_zobristPieceCastlingKingside[2];
 board_hash_t g_zobristPieceCastlingQueenside[2];
 
-void initZobrist() {
-  using SoFUtil::random;
+void initZobrist(const uint64_t seed) {
+  std::mt19937_64 gen(seed);
 
   for (size_t j = 0; j < 64; ++j) {
     g_zobristPieces[0][j] = 0;
   }
   for (size_t i = 1; i < 16; ++i) {
     for (size_t j = 0; j < 64; ++j) {
-      g_zobristPieces[i][j] = random();
+      g_zobristPieces[i][j] = gen();
     }
   }
-  g_zobristMoveSide = random();
+  g_zobristMoveSide = gen();
   for (board_hash_t &hash : g_zobristCastling) {
-    hash = random();
+    hash = gen();
   }
   for (board_hash_t &hash : g_zobristEnpassant) {
-    hash = random();
+    hash = gen();
   }
   for (Color c : {Color::White, Color::Black}) {
     const auto idx = static_cast<size_t>(c);
@@ -1,6 +1,8 @@
 #ifndef SOF_CORE_PRIVATE_ZOBRIST_INCLUDED
 #define SOF_CORE_PRIVATE_ZOBRIST_INCLUDED
 
+#include <cstdint>
+
 #include "core/types.h"
 
 namespace SoFCore::Private {
@@ -12,7 +14,9 @@ extern board_hash_t g_zobristEnpassant[64];
 extern board_hash_t g_zobristPieceCastlingKingside[2];
 extern board_hash_t g_zobristPieceCastlingQueenside[2];
 
-void initZobrist();
+// Generates Zobrist keys from the pseudo-random generator initialized with `seed`. The same seed
+// always gives the same keys
+void initZobrist(uint64_t seed);
 
 }  // namespace SoFCore::Private
 
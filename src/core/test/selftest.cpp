@@ -166,6 +166,14 @@ void runSelfTest(Board b) {
     if (isMoveLegal(b)) {
       testBoardValid(b);
     }
+    // Check that exactly the reversible moves are found by the change of the board hash
+    const bool isReversible = move.kind == MoveKind::Simple &&
+                              saved.cells[move.dst] == EMPTY_CELL &&
+                              cellPiece(saved.cells[move.src]) != Piece::Pawn &&
+                              saved.castling == b.castling && saved.enpassantCoord == INVALID_COORD;
+    if (isReversible != hasReversibleMove(saved, saved.hash ^ b.hash)) {
+      panic("hasReversibleMove() is incorrect for move \"" + moveToStr(move) + "\"");
+    }
     moveUnmake(b, move, p);
     if (!boardsBitCompare(b, saved)) {
       panic("Board becomes different after making and unmaking move \"" + moveToStr(move) + "\"");
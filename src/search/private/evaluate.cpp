@@ -13,32 +13,42 @@ using SoFCore::Move;
 using SoFCore::MoveKind;
 using SoFCore::Piece;
 
-score_pair_t boardGetPsqScore(const Board &b) {
-  score_pair_t result = 0;
+// Contribution of each piece into the game phase, indexed by cell. Pawns and kings don't contribute
+constexpr int PIECE_PHASE[16] = {0, 0, 0, 1, 1, 2, 4, 0, 0, 0, 0, 1, 1, 2, 4, 0};
+
+PsqScore boardGetPsqScore(const Board &b) {
+  PsqScore result{0, 0};
   for (coord_t i = 0; i < 64; ++i) {
-    result += PIECE_SQUARE_TABLE[b.cells[i]][i];
+    result.score += PIECE_SQUARE_TABLE[b.cells[i]][i];
+    result.phase += PIECE_PHASE[b.cells[i]];
   }
   return result;
 }
 
-score_pair_t boardUpdatePsqScore(const Board &b, const Move move, score_pair_t psq) {
+PsqScore boardUpdatePsqScore(const Board &b, const Move move, PsqScore psq) {
   const Color color = b.side;
   if (move.kind == MoveKind::CastlingKingside) {
-    return psq + SCORE_CASTLING_KINGSIDE_UPD[static_cast<size_t>(color)];
+    psq.score += SCORE_CASTLING_KINGSIDE_UPD[static_cast<size_t>(color)];
+    return psq;
   }
   if (move.kind == MoveKind::CastlingQueenside) {
-    return psq + SCORE_CASTLING_QUEENSIDE_UPD[static_cast<size_t>(color)];
+    psq.score += SCORE_CASTLING_QUEENSIDE_UPD[static_cast<size_t>(color)];
+    return psq;
   }
   const cell_t srcCell = b.cells[move.src];
   const cell_t dstCell = b.cells[move.dst];
-  psq -= PIECE_SQUARE_TABLE[srcCell][move.src] + PIECE_SQUARE_TABLE[dstCell][move.dst];
+  psq.score -= PIECE_SQUARE_TABLE[srcCell][move.src] + PIECE_SQUARE_TABLE[dstCell][move.dst];
+  psq.phase -= PIECE_PHASE[dstCell];
   if (isMoveKindPromote(move.kind)) {
-    return psq + PIECE_SQUARE_TABLE[makeCell(color, moveKindPromotePiece(move.kind))][move.dst];
+    const cell_t promoteCell = makeCell(color, moveKindPromotePiece(move.kind));
+    psq.score += PIECE_SQUARE_TABLE[promoteCell][move.dst];
+    psq.phase += PIECE_PHASE[promoteCell];
+    return psq;
   }
-  psq += PIECE_SQUARE_TABLE[srcCell][move.dst];
+  psq.score += PIECE_SQUARE_TABLE[srcCell][move.dst];
   if (move.kind == MoveKind::Enpassant) {
     const coord_t pawnPos = enpassantPawnPos(color, move.dst);
-    psq -= PIECE_SQUARE_TABLE[makeCell(invert(color), Piece::Pawn)][pawnPos];
+    psq.score -= PIECE_SQUARE_TABLE[makeCell(invert(color), Piece::Pawn)][pawnPos];
   }
   return psq;
 }
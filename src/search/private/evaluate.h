@@ -1,24 +1,42 @@
 #ifndef SOF_SEARCH_PRIVATE_EVALUATE_INCLUDED
 #define SOF_SEARCH_PRIVATE_EVALUATE_INCLUDED
 
+#include <algorithm>
+
 #include "core/board.h"
 #include "core/move.h"
 #include "search/private/score.h"
 
 namespace SoFSearch::Private {
 
-// Returns the position cost of `b`. `psq` must be strictly equal to `boardGetPsqScore(b)`.
-inline score_pair_t evaluate([[maybe_unused]] const SoFCore::Board &b, const score_pair_t psq) {
-  return scorePairFirst(psq);
+// Game phase in the initial position. The phase decreases as the pieces are exchanged, and becomes
+// zero when only kings and pawns remain on the board
+constexpr int PHASE_MAX = 24;
+
+// Position cost based on piece-square tables, together with the game phase. Both are updated
+// incrementally as the moves are made
+struct PsqScore {
+  score_pair_t score;  // Middlegame score and endgame score
+  int phase;
+};
+
+// Returns the position cost of `b`. `psq` must be strictly equal to `boardGetPsqScore(b)`. The cost
+// is interpolated between middlegame and endgame scores according to the game phase
+inline score_t evaluate([[maybe_unused]] const SoFCore::Board &b, const PsqScore psq) {
+  // The phase may exceed its initial value after promotions
+  const int phase = std::min(psq.phase, PHASE_MAX);
+  const int middlegame = scorePairFirst(psq.score);
+  const int endgame = scorePairSecond(psq.score);
+  return static_cast<score_t>((middlegame * phase + endgame * (PHASE_MAX - phase)) / PHASE_MAX);
 }
 
 // Returns the position cost of `b` based on piece-square tables.
-score_pair_t boardGetPsqScore(const SoFCore::Board &b);
+PsqScore boardGetPsqScore(const SoFCore::Board &b);
 
 // Returns the position cost of the board which is obtained by applying move `move` to board `b`.
 // This position cost is based on piece-square tables. `psq` must be strictly equal to
 // `boardGetPsqScore(b)`.
-score_pair_t boardUpdatePsqScore(const SoFCore::Board &b, SoFCore::Move move, score_pair_t psq);
+PsqScore boardUpdatePsqScore(const SoFCore::Board &b, SoFCore::Move move, PsqScore psq);
 
 }  // namespace SoFSearch::Private
 
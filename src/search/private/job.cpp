@@ -1,7 +1,8 @@
 #include "search/private/job.h"
 
 #include <algorithm>
-#include <chrono>
+#include <array>
+#include <iterator>
 #include <vector>
 
 #include "bot_api/types.h"
@@ -9,7 +10,10 @@
 #include "search/private/evaluate.h"
 #include "search/private/move_picker.h"
 #include "search/private/score.h"
+#include "search/private/see.h"
 #include "search/private/util.h"
+#include "util/defer.h"
+#include "util/misc.h"
 #include "util/random.h"
 
 namespace SoFSearch::Private {
@@ -19,8 +23,7 @@ using SoFCore::Board;
 using SoFCore::Color;
 using SoFCore::Move;
 using SoFCore::MovePersistence;
-using std::chrono::milliseconds;
-using std::chrono::steady_clock;
+using SoFCore::board_hash_t;
 
 void JobCommunicator::stop() {
   size_t tmp = 0;
@@ -28,11 +31,11 @@ void JobCommunicator::stop() {
     return;
   }
   // Lock and unlock `stopLock_` to ensure that we are not checking for `isStopped()` in
-  // `this->wait()` now. If we remove lock/unlock from here, the following may happen:
-  // - `this->wait()` checks for `isStopped()`, which returns `false`
+  // `this->waitUntil()` now. If we remove lock/unlock from here, the following may happen:
+  // - `this->waitUntil()` checks for `isStopped()`, which returns `false`
   // - we change `stopped_` to `1` and notify all the waiting threads
-  // - `this->wait()` goes to `stopEvent_.wait()` and doesn't wake, since the thread didn't started
-  // waiting when nofitication arrived
+  // - `this->waitUntil()` goes to `stopEvent_.wait_until()` and doesn't wake, since the thread
+  // didn't started waiting when nofitication arrived
   stopLock_.lock();
   stopLock_.unlock();
   stopEvent_.notify_all();
@@ -40,167 +43,990 @@ void JobCommunicator::stop() {
 
 constexpr size_t MAX_DEPTH = 255;
 
-class Searcher {
+// Minimum depth on which the node can become a split point in young brothers wait search. Splitting
+// on lower depths is not profitable, as the subtrees are too small compared to synchronization cost
+constexpr size_t SPLIT_MIN_DEPTH = 4;
+
+// Minimum depth on which the aspiration windows are used. On lower depths the score of the previous
+// iteration is not reliable enough
+constexpr size_t ASPIRATION_MIN_DEPTH = 5;
+
+// Initial half-width of the aspiration window. After each fail-low or fail-high, the window is
+// widened by `ASPIRATION_WIDEN_FACTOR` on the side of the failure
+constexpr int ASPIRATION_INITIAL_DELTA = 25;
+constexpr int ASPIRATION_WIDEN_FACTOR = 3;
+
+// Null move pruning parameters. The null move is searched with depth reduced by
+// `NULL_MOVE_REDUCTION + depth / NULL_MOVE_REDUCTION_DEPTH_DIV` plies. On depths greater or equal
+// than `NULL_MOVE_VERIFY_MIN_DEPTH`, the null move cutoff must be confirmed by a reduced search
+// without null moves, to avoid wrong cutoffs in zugzwang positions
+constexpr size_t NULL_MOVE_MIN_DEPTH = 3;
+constexpr size_t NULL_MOVE_REDUCTION = 3;
+constexpr size_t NULL_MOVE_REDUCTION_DEPTH_DIV = 6;
+constexpr size_t NULL_MOVE_VERIFY_MIN_DEPTH = 10;
+
+// Late move reductions parameters. The moves from `MovePickerStage::History` stage which come after
+// `LMR_MIN_MOVE_INDEX` other moves are searched with reduced depth, and re-searched with full depth
+// if they improve alpha. Moves with negative history score are reduced by one ply more, while the
+// moves whose history score is at least `LMR_HISTORY_GOOD` are reduced by one ply less
+constexpr size_t LMR_MIN_DEPTH = 3;
+constexpr size_t LMR_MIN_MOVE_INDEX = 3;
+constexpr int LMR_HISTORY_GOOD = HISTORY_MAX / 2;
+constexpr double LMR_BASE = 0.75;
+constexpr double LMR_DIVISOR = 2.25;
+
+// Size of reduction table along each of the dimensions. Larger depths and move indices use the last
+// entry
+constexpr size_t LMR_TABLE_SZ = 64;
+
+// Natural logarithm which can be computed at compile time. `x` must be positive
+inline static constexpr double constexprLog(const double x) {
+  // Use the series `ln(x) = 2 * (y + y^3 / 3 + y^5 / 5 + ...)`, where `y = (x - 1) / (x + 1)`
+  const double y = (x - 1) / (x + 1);
+  double term = y;
+  double sum = 0;
+  for (int i = 1; i < 400; i += 2) {
+    sum += term / i;
+    term *= y * y;
+  }
+  return 2 * sum;
+}
+
+inline static constexpr auto makeLmrTable() {
+  std::array<double, LMR_TABLE_SZ> logs{};
+  for (size_t i = 1; i < LMR_TABLE_SZ; ++i) {
+    logs[i] = constexprLog(static_cast<double>(i));
+  }
+  std::array<std::array<uint8_t, LMR_TABLE_SZ>, LMR_TABLE_SZ> table{};
+  for (size_t depth = 1; depth < LMR_TABLE_SZ; ++depth) {
+    for (size_t index = 1; index < LMR_TABLE_SZ; ++index) {
+      table[depth][index] =
+          static_cast<uint8_t>(LMR_BASE + logs[depth] * logs[index] / LMR_DIVISOR);
+    }
+  }
+  return table;
+}
+
+// Base reductions for late move reductions, indexed by depth and by move index
+constexpr auto LMR_TABLE = makeLmrTable();
+
+// Shallow depth pruning parameters. All the margins are in centipawns, and the arrays are indexed
+// by depth:
+// - reverse futility pruning: the node is pruned if static evaluation exceeds beta by
+//   `REVERSE_FUTILITY_MARGIN` per ply of depth
+// - razoring: if static evaluation is below alpha by `RAZORING_MARGIN`, the node is checked with
+//   quiescence search first
+// - futility pruning: quiet moves are skipped if static evaluation is below alpha by
+//   `FUTILITY_MARGIN`
+// - move count pruning: quiet moves are skipped after `MOVE_COUNT_PRUNING_LIMIT` moves are tried
+constexpr size_t REVERSE_FUTILITY_MAX_DEPTH = 6;
+constexpr int REVERSE_FUTILITY_MARGIN = 90;
+constexpr int RAZORING_MARGIN[] = {0, 250, 400};
+constexpr int FUTILITY_MARGIN[] = {0, 150, 250, 350};
+constexpr size_t MOVE_COUNT_PRUNING_LIMIT[] = {0, 6, 10, 16};
+constexpr size_t RAZORING_MAX_DEPTH = std::size(RAZORING_MARGIN) - 1;
+constexpr size_t FUTILITY_MAX_DEPTH = std::size(FUTILITY_MARGIN) - 1;
+constexpr size_t MOVE_COUNT_PRUNING_MAX_DEPTH = std::size(MOVE_COUNT_PRUNING_LIMIT) - 1;
+
+// The moves in split points are never pruned, so the pruning must not be applied on depths where
+// split is possible
+static_assert(FUTILITY_MAX_DEPTH < SPLIT_MIN_DEPTH);
+static_assert(MOVE_COUNT_PRUNING_MAX_DEPTH < SPLIT_MIN_DEPTH);
+
+// Singular extension parameters. If the hash move has a lower bound entry in the transposition
+// table with depth not less than `depth - SINGULAR_TT_DEPTH_MARGIN`, all the other moves are
+// searched with half depth against the bound lowered by `SINGULAR_MARGIN` per ply of depth. If all
+// of them fail low, the hash move is singular and is extended by one ply. If the bound is not less
+// than beta, then multiple moves beat beta, and the node is pruned (multi-cut)
+constexpr size_t SINGULAR_MIN_DEPTH = 8;
+constexpr size_t SINGULAR_TT_DEPTH_MARGIN = 3;
+constexpr int SINGULAR_MARGIN = 2;
+
+// ProbCut parameters. In non-PV nodes with depth at least `PROBCUT_MIN_DEPTH`, the captures which
+// win enough material by static exchange evaluation are searched against `beta + PROBCUT_MARGIN`
+// with depth reduced by `PROBCUT_REDUCTION` plies. If any of them beats this bound, the node is
+// pruned, as the full depth search would likely fail high too
+constexpr size_t PROBCUT_MIN_DEPTH = 5;
+constexpr size_t PROBCUT_REDUCTION = 4;
+constexpr int PROBCUT_MARGIN = 200;
+
+// Quiescence search pruning parameters. If the side to move is not in check, the captures which
+// lose material by static exchange evaluation are skipped, and so are the captures which cannot
+// raise static evaluation above alpha even with extra `QUIESCENCE_DELTA_MARGIN` (delta pruning)
+constexpr int QUIESCENCE_DELTA_MARGIN = 200;
+
+// Internal iterative search parameters, which are used when there is no hash move in PV or non-PV
+// node with depth at least `INTERNAL_ITERATIVE_MIN_DEPTH`. Internal iterative deepening searches
+// PV nodes with depth reduced by `IID_PV_REDUCTION` plies and non-PV nodes with half depth to find
+// the hash move. Internal iterative reductions reduce the depth by `IIR_REDUCTION` plies instead
+constexpr size_t INTERNAL_ITERATIVE_MIN_DEPTH = 5;
+constexpr size_t IID_PV_REDUCTION = 2;
+constexpr size_t IIR_REDUCTION = 1;
+
+// History update parameters. When a move causes beta cutoff, its history gets a bonus of
+// `HISTORY_BONUS_PER_DEPTH2` per squared depth (but no more than `HISTORY_BONUS_MAX`). Up to
+// `HISTORY_MALUS_MAX_MOVES` quiet moves and captures searched before it get the same malus in
+// quiet and capture history respectively
+constexpr int HISTORY_BONUS_PER_DEPTH2 = 32;
+constexpr int HISTORY_BONUS_MAX = 2048;
+constexpr size_t HISTORY_MALUS_MAX_MOVES = 32;
+
+// Returns `true` if side `c` has pieces other than pawns and king. If it doesn't, zugzwang is
+// likely, and null move pruning becomes unsound
+inline static bool hasNonPawnMaterial(const Board &b, const Color c) {
+  using SoFCore::makeCell;
+  using SoFCore::Piece;
+  return (b.bbColor(c) ^ b.bbPieces[makeCell(c, Piece::Pawn)] ^
+          b.bbPieces[makeCell(c, Piece::King)]) != 0;
+}
+
+// Moves of the root node, which persist across the iterations of iterative deepening. Before each
+// search, the moves are ordered by the results of the previous one: first the moves which improved
+// alpha by their scores, then the remaining ones by the number of nodes in their subtrees, as the
+// moves which were harder to refute are more likely to become best.
+//
+// In multi-PV mode, only the moves starting from index `first()` are searched, and the best moves
+// of the previous lines are kept before this index
+class RootMoveList {
 public:
-  enum class NodeKind { Root, Pv, Simple };
+  struct Item {
+    Move move;
+    score_t score;  // `-SCORE_INF` if the move didn't improve alpha
+    uint64_t nodes;
+  };
+
+  inline bool isInitialized() const { return isInitialized_; }
+
+  // Fills the list with the legal moves from `picker`, keeping their order. The lazy SMP helpers
+  // perturb the order depending on `jobId`, so different jobs start with different moves
+  void init(Board &board, MovePicker picker, size_t jobId);
+
+  // Excludes the moves before index `first` from the search, then orders the remaining moves by the
+  // results of the previous search and clears these results. The order is perturbed in the same way
+  // as in `init()`. Must be called once before searching each line on each depth
+  void prepare(size_t jobId, size_t first);
 
-  inline Searcher(Job &job, Board &board, const SearchLimits &limits, RepetitionTable &repetitions)
-      : board_(board),
+  // Same as `prepare()`, but for the re-search of the same line on the same depth with another
+  // aspiration window. The node counts are kept, so they cover all the searches of the line
+  void prepareResearch(size_t jobId);
+
+  // Moves the move `move` to index `index`, shifting the moves between them. Does nothing if there
+  // is no such move after this index
+  void moveTo(size_t index, Move move);
+
+  // Stores the results of the search of the move `move`
+  inline void update(const Move move, const score_t score, const uint64_t nodes) {
+    for (size_t i = 0; i < count_; ++i) {
+      if (items_[i].move == move) {
+        items_[i].score = score;
+        items_[i].nodes += nodes;
+        return;
+      }
+    }
+  }
+
+  // Returns the share of nodes spent on the move `bestMove` since the last call of `prepare()`
+  double nodeFraction(Move bestMove) const;
+
+  inline size_t first() const { return first_; }
+  inline size_t size() const { return count_; }
+  inline Move operator[](const size_t index) const { return items_[index].move; }
+
+private:
+  void sortByResults();
+  void perturb(size_t jobId);
+
+  Item items_[SoFCore::BUFSZ_MOVES];
+  size_t first_ = 0;
+  size_t count_ = 0;
+  bool isInitialized_ = false;
+};
+
+void RootMoveList::init(Board &board, MovePicker picker, const size_t jobId) {
+  for (Move move = picker.next(); move != Move::invalid(); move = picker.next()) {
+    if (move == Move::null()) {
+      continue;
+    }
+    const MovePersistence persistence = moveMake(board, move);
+    const bool isLegal = isMoveLegal(board);
+    moveUnmake(board, move, persistence);
+    if (isLegal) {
+      items_[count_++] = Item{move, -SCORE_INF, 0};
+    }
+  }
+  isInitialized_ = true;
+  perturb(jobId);
+}
+
+void RootMoveList::prepare(const size_t jobId, const size_t first) {
+  first_ = first;
+  sortByResults();
+  for (size_t i = first_; i < count_; ++i) {
+    items_[i].score = -SCORE_INF;
+    items_[i].nodes = 0;
+  }
+  perturb(jobId);
+}
+
+void RootMoveList::prepareResearch(const size_t jobId) {
+  sortByResults();
+  for (size_t i = first_; i < count_; ++i) {
+    items_[i].score = -SCORE_INF;
+  }
+  perturb(jobId);
+}
+
+void RootMoveList::sortByResults() {
+  std::stable_sort(items_ + first_, items_ + count_, [](const Item &a, const Item &b) {
+    return a.score != b.score ? a.score > b.score : a.nodes > b.nodes;
+  });
+}
+
+void RootMoveList::moveTo(const size_t index, const Move move) {
+  for (size_t i = index; i < count_; ++i) {
+    if (items_[i].move == move) {
+      std::rotate(items_ + index, items_ + i, items_ + i + 1);
+      return;
+    }
+  }
+}
+
+double RootMoveList::nodeFraction(const Move bestMove) const {
+  uint64_t total = 0;
+  uint64_t best = 0;
+  for (size_t i = first_; i < count_; ++i) {
+    total += items_[i].nodes;
+    if (items_[i].move == bestMove) {
+      best = items_[i].nodes;
+    }
+  }
+  return total == 0 ? 0.0 : static_cast<double>(best) / static_cast<double>(total);
+}
+
+void RootMoveList::perturb(const size_t jobId) {
+  if (jobId == 0) {
+    return;
+  }
+  if (jobId < count_ - first_) {
+    std::reverse(items_ + first_, items_ + first_ + jobId);
+  } else {
+    SoFUtil::randomShuffle(items_ + first_, items_ + count_);
+  }
+}
+
+class Searcher {
+public:
+  // Creates the searcher which is allowed to visit no more than `nodeBudget` nodes. In young
+  // brothers wait mode, this budget is shared with the other jobs via `JobCommunicator`
+  inline Searcher(Job &job, Board &board, HashHistory &hashes, const uint64_t nodeBudget)
+      : job_(job),
+        board_(board),
         tt_(job.table_),
         comm_(job.communicator_),
         results_(job.results_),
-        repetitions_(repetitions),
-        limits_(limits),
+        hashes_(hashes),
+        pool_(job.pool_),
+        internalIterativeMode_(job.internalIterativeMode_),
         jobId_(job.id_),
-        startTime_(steady_clock::now()) {}
+        tables_(*job.tables_),
+        nodesLeft_(nodeBudget),
+        isBudgetShared_(job.pool_ && nodeBudget != NODES_UNLIMITED) {
+    tables_.killers.resize(std::size(stack_));
+    killers_ = tables_.killers.data();
+    hashes_.reserve(std::size(stack_));
+  }
 
-  inline score_t run(const size_t depth, Move &bestMove) {
+  // Generates the moves in the root node. Must be called once before the first call of `run()`
+  inline void initRootMoves() {
+    rootMoves_.init(board_, MovePicker(board_, Move::null(), killers_[0], moveHistory(0)), jobId_);
+  }
+
+  // Returns the number of legal moves in the root node
+  inline size_t rootMoveCount() const { return rootMoves_.size(); }
+
+  // Searches the root node on depth `depth`. The root moves before index `line` are excluded from
+  // the search, as they are the best moves of the previous lines in multi-PV mode. `isResearch`
+  // must be `true` if the same line on the same depth was already searched with another window
+  inline score_t run(const size_t depth, const size_t line, const score_t alpha, const score_t beta,
+                     const bool isResearch, Move &bestMove) {
     depth_ = depth;
-    const score_t score =
-        search<NodeKind::Root>(depth, 0, -SCORE_INF, SCORE_INF, boardGetPsqScore(board_));
+    if (isResearch) {
+      rootMoves_.prepareResearch(jobId_);
+    } else {
+      rootMoves_.prepare(jobId_, line);
+    }
+    const score_t score = search<NodeKind::Root>(depth, 0, alpha, beta, boardGetPsqScore(board_));
     bestMove = stack_[0].bestMove;
     return score;
   }
 
+  // Makes `bestMove` the best move of the line `line`, so it's excluded from the next lines
+  inline void finishLine(const size_t line, const Move bestMove) {
+    rootMoves_.moveTo(line, bestMove);
+  }
+
+  // Returns `true` if the searcher has exhausted its own node budget
+  inline bool isOutOfNodes() const { return isOutOfNodes_; }
+
+  // Returns the share of nodes spent on the best move in the current line, including all the
+  // aspiration re-searches
+  inline double bestMoveNodeFraction() const { return rootMoves_.nodeFraction(stack_[0].bestMove); }
+
+  // Joins the split point `sp` as a helper and searches the moves there until they are exhausted
+  void runSplitPoint(SplitPoint &sp);
+
 private:
   struct Frame {
-    KillerLine killers;  // Must be preserved across recursive calls
     Move bestMove = Move::null();
+    Move move = Move::invalid();  // Move which is currently searched from this node
+    PieceSquare movePiece;  // Moved piece and destination of `move`, empty for null move
+    Move excludedMove = Move::null();  // Move which must be skipped by singular extension search
+  };
+
+  // Moves which were searched in the node and didn't cause beta cutoff
+  struct FailedMoves {
+    Move quiets[HISTORY_MALUS_MAX_MOVES];
+    Move captures[HISTORY_MALUS_MAX_MOVES];
+    size_t quietCount = 0;
+    size_t captureCount = 0;
+
+    // Remembers the move `move` from stage `stage`, if there is enough space for it
+    inline void add(const Move move, const MovePickerStage stage) {
+      if (isQuietStage(stage) && quietCount < HISTORY_MALUS_MAX_MOVES) {
+        quiets[quietCount++] = move;
+      } else if (isCaptureStage(stage) && captureCount < HISTORY_MALUS_MAX_MOVES) {
+        captures[captureCount++] = move;
+      }
+    }
   };
 
+  // Tries to prune the node using null move. Returns `true` if the node must be pruned with score
+  // `beta`. `staticScore` is static evaluation of the current position. Must not be called when in
+  // check
+  bool tryNullMove(size_t depth, size_t idepth, score_t beta, PsqScore psq,
+                   score_t staticScore);
+
+  // Tries to prune the node using ProbCut. Returns `true` if the node must be pruned with score
+  // `beta`. `staticScore` is static evaluation of the current position. Must not be called when in
+  // check
+  bool tryProbCut(size_t depth, size_t idepth, score_t beta, PsqScore psq,
+                  score_t staticScore);
+
+  // Returns `true` if the search must be stopped. The time limit is not checked here, as it's
+  // enforced by `JobRunner`, which calls `JobCommunicator::stop()` when the deadline is reached
   inline bool mustStop() const {
-    if (comm_.isStopped()) {
+    if (comm_.isStopped() || isOutOfNodes_) {
+      return true;
+    }
+    if (activeSp_ && activeSp_->isCutoff()) {
       return true;
     }
-    ++counter_;
-    if (!(counter_ & 4095)) {
-      if (limits_.time != TIME_UNLIMITED && steady_clock::now() - startTime_ >= limits_.time) {
+    return comm_.depth() != depth_;
+  }
+
+  // Accounts the node which was just entered by making a move. If the node budget is exhausted,
+  // stops the search and returns `false`. In this case, the move must be unmade without searching
+  // it, so the jobs visit exactly as many nodes as allowed by their budgets. If the budget is
+  // shared, then all the jobs are stopped. Otherwise, only this job stops, and the whole search is
+  // stopped when all the jobs exhaust their budgets
+  inline bool countNode() {
+    if (isBudgetShared_) {
+      if (SOF_UNLIKELY(!comm_.takeSharedNode())) {
         comm_.stop();
-        return true;
+        return false;
       }
+    } else {
+      if (SOF_UNLIKELY(nodesLeft_ == 0)) {
+        if (!isOutOfNodes_) {
+          isOutOfNodes_ = true;
+          comm_.exhaustOwnBudget();
+        }
+        return false;
+      }
+      --nodesLeft_;
     }
-    return comm_.depth() != depth_;
+    ++nodes_;
+    results_.inc(JobStat::Nodes);
+    return true;
   }
 
   template <NodeKind Node>
-  inline score_t search(const size_t depth, const size_t idepth, const score_t alpha,
-                        const score_t beta, const score_pair_t psq) {
+  inline score_t search(const size_t depth, const size_t idepth, score_t alpha,
+                        const score_t beta, const PsqScore psq) {
     tt_.prefetch(board_.hash);
-    if (!repetitions_.insert(board_.hash)) {
+    const bool isRepetition =
+        hashes_.push(board_, idepth != 0 && stack_[idepth - 1].move == Move::null());
+    SOF_DEFER({ hashes_.pop(); });
+    if constexpr (Node != NodeKind::Root) {
+      if (isRepetition) {
+        return 0;
+      }
+      // If we can force a draw by repetition, then the score cannot be lower than the draw
+      if (alpha < 0 && hashes_.hasUpcomingRepetition(board_)) {
+        if (beta <= 0) {
+          return beta;
+        }
+        alpha = 0;
+      }
+    }
+    return doSearch<Node>(depth, idepth, alpha, beta, psq);
+  }
+
+  // Returns static evaluation of the current position from the point of view of the side to move
+  inline score_t staticEvaluate(const PsqScore psq) const {
+    const score_t score = evaluate(board_, psq);
+    return (board_.side == Color::White) ? score : -score;
+  }
+
+  // Returns `true` if the move which was just made on the board is quiet, i.e. it may be pruned or
+  // reduced. `stage` is the stage of the move, `inCheck` is `true` if the side which made the move
+  // was in check, and `givesCheck` is `true` if the move gives check
+  inline static bool isQuietMadeMove(const MovePickerStage stage, const bool inCheck,
+                                     const bool givesCheck) {
+    return stage == MovePickerStage::History && !inCheck && !givesCheck;
+  }
+
+  // Returns `true` if the moves from the node at distance `idepth` from root with remaining depth
+  // `depth` may be extended by one ply. The extensions are allowed only while the line is shorter
+  // than twice the iteration depth, so the search never explodes because of them. Also, the line
+  // together with its remaining depth must not grow longer than `MAX_DEPTH`, otherwise it won't fit
+  // into the stack
+  inline bool canExtend(const size_t idepth, const size_t depth) const {
+    return idepth < 2 * depth_ && idepth + depth < MAX_DEPTH;
+  }
+
+  // Remembers that the move `move` is searched from the node at distance `idepth` from root. Must
+  // be called right after the move is made on the board
+  inline void setMadeMove(const size_t idepth, const Move move) {
+    Frame &frame = stack_[idepth];
+    frame.move = move;
+    frame.movePiece =
+        (move == Move::null()) ? PieceSquare{} : PieceSquare{board_.cells[move.dst], move.dst};
+  }
+
+  // Returns the keys of the moves which led to the node at distance `idepth` from root
+  inline PrevMoves prevMoves(const size_t idepth) const {
+    PrevMoves result;
+    for (size_t i = 0; i < CONTINUATION_PLIES && i < idepth; ++i) {
+      result[i] = stack_[idepth - 1 - i].movePiece;
+    }
+    return result;
+  }
+
+  // Returns the heuristics to order the moves in the node at distance `idepth` from root
+  inline MoveHistory moveHistory(const size_t idepth) const {
+    const PrevMoves prev = prevMoves(idepth);
+    MoveHistory result{tables_.history, tables_.captures, {}, Move::null()};
+    for (size_t i = 0; i < CONTINUATION_PLIES; ++i) {
+      result.continuations[i] = prev[i].isValid() ? &tables_.continuations[prev[i]] : nullptr;
+    }
+    if (prev[0].isValid()) {
+      result.counterMove = tables_.counterMoves[prev[0]];
+    }
+    return result;
+  }
+
+  // Updates the history of the quiet move `move` from the node at distance `idepth` from root.
+  // The move must not be made on the board
+  inline void updateQuietHistory(const size_t idepth, const Move move, const int bonus) {
+    tables_.history.update(move, bonus);
+    const PieceSquare key{board_.cells[move.src], move.dst};
+    for (const PieceSquare prev : prevMoves(idepth)) {
+      if (prev.isValid()) {
+        tables_.continuations[prev].update(key, bonus);
+      }
+    }
+  }
+
+  // Updates the history of the capture `move` from the current node. The move must not be made on
+  // the board
+  inline void updateCaptureHistory(const Move move, const int bonus) {
+    tables_.captures.update(PieceSquare{board_.cells[move.src], move.dst}, board_.cells[move.dst],
+                           bonus);
+  }
+
+  // Returns the number of plies by which the quiet move which was just made on the board must be
+  // reduced. `index` is the number of moves searched before this one, and `history` is the history
+  // score of the move
+  template <NodeKind Node>
+  inline size_t lmrReduction(const size_t depth, const size_t index, const int history) {
+    if (depth < LMR_MIN_DEPTH || index < LMR_MIN_MOVE_INDEX) {
       return 0;
     }
-    const score_t score = doSearch<Node>(depth, idepth, alpha, beta, psq);
-    repetitions_.erase(board_.hash);
-    return score;
+    size_t reduction =
+        LMR_TABLE[std::min(depth, LMR_TABLE_SZ - 1)][std::min(index, LMR_TABLE_SZ - 1)];
+    if constexpr (Node == NodeKind::Pv) {
+      reduction = (reduction == 0) ? 0 : reduction - 1;
+    }
+    if (history < 0) {
+      ++reduction;
+    } else if (history >= LMR_HISTORY_GOOD) {
+      reduction = (reduction == 0) ? 0 : reduction - 1;
+    }
+    // Don't reduce the move directly into quiescence search
+    return std::min(reduction, depth - 2);
+  }
+
+  // Searches the move which was just made on the board using principal variation search. If
+  // `isFirst` is `false`, the move is searched with null window first, and the search with full
+  // window is done only if the move may improve `alpha`. If `reduction` is not zero, the null
+  // window search is preceded by the search with depth reduced by `reduction` plies
+  template <NodeKind Node>
+  inline score_t searchMadeMove(const size_t depth, const size_t idepth, const score_t alpha,
+                                const score_t beta, const PsqScore psq, const bool isFirst,
+                                const size_t reduction) {
+    constexpr NodeKind newNode = (Node == NodeKind::Simple ? NodeKind::Simple : NodeKind::Pv);
+    if (reduction != 0) {
+      const score_t score =
+          -search<NodeKind::Simple>(depth - 1 - reduction, idepth + 1, -alpha - 1, -alpha, psq);
+      if (score <= alpha) {
+        return score;
+      }
+    }
+    if (!isFirst) {
+      const score_t score =
+          -search<NodeKind::Simple>(depth - 1, idepth + 1, -alpha - 1, -alpha, psq);
+      if (score <= alpha) {
+        return score;
+      }
+    }
+    return -search<newNode>(depth - 1, idepth + 1, -beta, -alpha, psq);
+  }
+
+  // Updates the move ordering heuristics after move `move` caused beta cutoff in the node at
+  // distance `idepth` from root. `failed` are the moves which were searched in this node before
+  // `move` and didn't cause the cutoff, or `nullptr` if they are unknown
+  template <NodeKind Node>
+  inline void updateOnCutoff(const size_t idepth, const Move move, const MovePickerStage stage,
+                             const size_t depth, const FailedMoves *failed) {
+    if constexpr (Node != NodeKind::Root) {
+      const int bonus = std::min(HISTORY_BONUS_PER_DEPTH2 * static_cast<int>(depth * depth),
+                                 HISTORY_BONUS_MAX);
+      if (failed) {
+        for (size_t i = 0; i < failed->captureCount; ++i) {
+          updateCaptureHistory(failed->captures[i], -bonus);
+        }
+      }
+      if (isCaptureStage(stage)) {
+        updateCaptureHistory(move, bonus);
+        return;
+      }
+      if (!isQuietStage(stage)) {
+        return;
+      }
+      killers_[idepth].add(move);
+      updateQuietHistory(idepth, move, bonus);
+      if (failed) {
+        for (size_t i = 0; i < failed->quietCount; ++i) {
+          updateQuietHistory(idepth, failed->quiets[i], -bonus);
+        }
+      }
+      if (const PieceSquare prev = stack_[idepth - 1].movePiece; prev.isValid()) {
+        tables_.counterMoves[prev] = move;
+      }
+    }
+  }
+
+  // Returns `true` if the current node may become a split point
+  inline bool canSplit(const size_t depth) const {
+    return pool_ && depth >= SPLIT_MIN_DEPTH && pool_->hasIdleHelpers();
   }
 
+  // Turns the current node into a split point, and searches the remaining moves from `picker`
+  // together with the helpers. Updates `alpha` and the best move in the current frame
+  template <NodeKind Node, typename Picker>
+  void split(Picker &picker, size_t depth, size_t idepth, score_t &alpha, score_t beta,
+             PsqScore psq);
+
+  // Searches the moves in the split point `sp` until they are exhausted
+  template <NodeKind Node>
+  void searchSplitPoint(SplitPoint &sp);
+
+  // Waits until all the helpers leave the split point `sp`, which was created by this searcher.
+  // Meanwhile, joins the split points below `sp` and searches them, so master doesn't stay idle
+  void waitHelpers(SplitPoint &sp);
+
   template <NodeKind Node>
-  score_t doSearch(size_t depth, size_t idepth, score_t alpha, score_t beta, score_pair_t psq);
+  score_t doSearch(size_t depth, size_t idepth, score_t alpha, score_t beta, PsqScore psq);
 
-  score_t quiescenseSearch(score_t alpha, score_t beta, score_pair_t psq);
+  // Searches only captures and promotions to resolve the tactics before evaluating the position
+  // statically. If the side to move is in check, all the evasions are searched instead. The
+  // results are stored into the transposition table with zero depth, so they are never used as
+  // cutoffs by the main search, but still provide hash moves for it
+  score_t quiescenseSearch(size_t idepth, score_t alpha, score_t beta, PsqScore psq);
 
+  Job &job_;
   Board &board_;
   TranspositionTable &tt_;
   JobCommunicator &comm_;
   JobResults &results_;
-  RepetitionTable &repetitions_;
-  SearchLimits limits_;
+  HashHistory &hashes_;
+  SplitPointPool *pool_;
+  SplitPoint *activeSp_ = nullptr;
+  InternalIterativeMode internalIterativeMode_;
   size_t jobId_;
 
   Frame stack_[MAX_DEPTH + 10];
-  HistoryTable history_;
+  OrderingTables &tables_;
+  KillerLine *killers_;  // Killers from `tables_`, indexed by distance from root
+  RootMoveList rootMoves_;
   size_t depth_ = 0;
-  mutable size_t counter_ = 0;
-  steady_clock::time_point startTime_;
+  size_t nullMoveMinIdepth_ = 0;  // Null moves are not allowed on smaller depths from root
+  uint64_t nodesLeft_;
+  uint64_t nodes_ = 0;  // Number of nodes visited by this searcher
+  bool isBudgetShared_;
+  bool isOutOfNodes_ = false;
 };
 
 class RootNodeMovePicker {
 public:
-  RootNodeMovePicker(MovePicker picker, const size_t jobId) {
-    for (Move move = picker.next(); move != Move::invalid(); move = picker.next()) {
-      if (move == Move::null()) {
-        continue;
-      }
-      moves_[moveCount_++] = move;
-    }
-    if (jobId == 0) {
-      return;
-    }
-    if (jobId < moveCount_) {
-      std::reverse(moves_, moves_ + jobId);
-    } else {
-      SoFUtil::randomShuffle(moves_, moves_ + moveCount_);
-    }
-  }
+  explicit RootNodeMovePicker(const RootMoveList &moves) : moves_(moves), pos_(moves.first()) {}
 
   inline Move next() {
-    if (pos_ == moveCount_) {
+    if (pos_ == moves_.size()) {
       return Move::invalid();
     }
     return moves_[pos_++];
   }
 
 private:
-  Move moves_[SoFCore::BUFSZ_MOVES];
-  size_t moveCount_ = 0;
-  size_t pos_ = 0;
+  const RootMoveList &moves_;
+  size_t pos_;
 };
 
-template <Searcher::NodeKind Kind>
+template <NodeKind Kind>
 struct MovePickerFactory {
   template <typename... Args>
-  inline static MovePicker create([[maybe_unused]] const size_t jobId, Args &&... args) {
+  inline static MovePicker create([[maybe_unused]] const RootMoveList &rootMoves,
+                                  Args &&... args) {
     return MovePicker(std::forward<Args>(args)...);
   }
 };
 
 template <>
-struct MovePickerFactory<Searcher::NodeKind::Root> {
+struct MovePickerFactory<NodeKind::Root> {
   template <typename... Args>
-  inline static RootNodeMovePicker create(const size_t jobId, Args &&... args) {
-    return RootNodeMovePicker(MovePicker(std::forward<Args>(args)...), jobId);
+  inline static RootNodeMovePicker create(const RootMoveList &rootMoves, Args &&...) {
+    return RootNodeMovePicker(rootMoves);
   }
 };
 
-score_t Searcher::quiescenseSearch(score_t alpha, const score_t beta, const score_pair_t psq) {
-  score_t score = evaluate(board_, psq);
-  if (board_.side == Color::Black) {
-    score *= -1;
+score_t Searcher::quiescenseSearch(const size_t idepth, score_t alpha, const score_t beta,
+                                   const PsqScore psq) {
+  // Evasions are searched when in check, so the lines of checks and evasions may grow long. Stop
+  // them with static evaluation when they become too long
+  if (idepth >= MAX_DEPTH) {
+    return std::clamp(staticEvaluate(psq), alpha, beta);
   }
-  alpha = std::max(alpha, score);
-  if (alpha >= beta) {
-    return beta;
+
+  const score_t origAlpha = alpha;
+
+  auto ttStore = [&](score_t score, const Move bestMove) {
+    PositionCostBound bound = PositionCostBound::Exact;
+    if (score <= origAlpha) {
+      score = origAlpha;
+      bound = PositionCostBound::Upperbound;
+    }
+    if (score >= beta) {
+      score = beta;
+      bound = PositionCostBound::Lowerbound;
+    }
+    score = adjustCheckmate(score, -static_cast<int16_t>(idepth));
+    tt_.store(board_.hash, TranspositionTable::Data(bestMove, score, 0, bound));
+  };
+
+  // Probe the transposition table. Any entry is deep enough for quiescence search
+  Move hashMove = Move::null();
+  const TranspositionTable::Data ttData = tt_.load(board_.hash);
+  if (ttData.isValid()) {
+    results_.inc(JobStat::TtHits);
+    hashMove = ttData.move();
+    if (board_.moveCounter < 90) {
+      const score_t score = adjustCheckmate(ttData.score(), idepth);
+      switch (ttData.bound()) {
+        case PositionCostBound::Exact: {
+          return std::clamp(score, alpha, beta);
+        }
+        case PositionCostBound::Lowerbound: {
+          if (score >= beta) {
+            return beta;
+          }
+          break;
+        }
+        case PositionCostBound::Upperbound: {
+          if (alpha >= score) {
+            return alpha;
+          }
+          break;
+        }
+      }
+    }
   }
 
-  QuiescenseMovePicker picker(board_);
+  // If we are in check, then standing pat is not allowed, as the position may be lost
+  const bool inCheck = isCheck(board_);
+  score_t staticScore = 0;
+  if (!inCheck) {
+    staticScore = staticEvaluate(psq);
+    alpha = std::max(alpha, staticScore);
+    if (alpha >= beta) {
+      return beta;
+    }
+  }
+
+  QuiescenseMovePicker picker(board_, hashMove, inCheck);
+  Move bestMove = Move::null();
+  bool hasLegalMoves = false;
   for (Move move = picker.next(); move != Move::invalid(); move = picker.next()) {
     if (move == Move::null()) {
       continue;
     }
-    const score_pair_t newPsq = boardUpdatePsqScore(board_, move, psq);
+    if (!inCheck) {
+      // Skip the captures which cannot improve alpha or lose material
+      const int maxGain = moveMaterialGain(board_, move) + QUIESCENCE_DELTA_MARGIN;
+      if (staticScore + maxGain <= alpha || !isSeeAtLeast(board_, move, 0)) {
+        continue;
+      }
+    }
+    const PsqScore newPsq = boardUpdatePsqScore(board_, move, psq);
     const MovePersistence persistence = moveMake(board_, move);
     if (!isMoveLegal(board_)) {
       moveUnmake(board_, move, persistence);
       continue;
     }
-    results_.inc(JobStat::Nodes);
-    const score_t score = -quiescenseSearch(-beta, -alpha, newPsq);
+    hasLegalMoves = true;
+    if (!countNode()) {
+      moveUnmake(board_, move, persistence);
+      return 0;
+    }
+    const score_t score = -quiescenseSearch(idepth + 1, -beta, -alpha, newPsq);
     moveUnmake(board_, move, persistence);
     if (mustStop()) {
       return 0;
     }
-    alpha = std::max(alpha, score);
+    if (score > alpha) {
+      alpha = score;
+      bestMove = move;
+    }
     if (alpha >= beta) {
+      ttStore(beta, bestMove);
       return beta;
     }
   }
 
+  if (inCheck && !hasLegalMoves) {
+    return scoreCheckmateLose(idepth);
+  }
+
+  ttStore(alpha, bestMove);
   return alpha;
 }
 
-template <Searcher::NodeKind Node>
-score_t Searcher::doSearch(const size_t depth, const size_t idepth, score_t alpha,
-                           const score_t beta, const score_pair_t psq) {
+bool Searcher::tryNullMove(const size_t depth, const size_t idepth, const score_t beta,
+                           const PsqScore psq, const score_t staticScore) {
+  if (depth < NULL_MOVE_MIN_DEPTH || idepth < nullMoveMinIdepth_ || isScoreCheckmate(beta) ||
+      staticScore < beta || (idepth != 0 && stack_[idepth - 1].move == Move::null()) ||
+      !hasNonPawnMaterial(board_, board_.side)) {
+    return false;
+  }
+
+  const size_t reduction = NULL_MOVE_REDUCTION + depth / NULL_MOVE_REDUCTION_DEPTH_DIV;
+  const size_t newDepth = (depth > reduction + 1) ? depth - reduction - 1 : 0;
+  const MovePersistence persistence = moveMake(board_, Move::null());
+  setMadeMove(idepth, Move::null());
+  if (!countNode()) {
+    moveUnmake(board_, Move::null(), persistence);
+    return false;
+  }
+  const score_t score = -search<NodeKind::Simple>(newDepth, idepth + 1, -beta, -beta + 1, psq);
+  moveUnmake(board_, Move::null(), persistence);
+  if (mustStop() || score < beta) {
+    return false;
+  }
+  if (depth < NULL_MOVE_VERIFY_MIN_DEPTH) {
+    return true;
+  }
+
+  // Verify the cutoff with reduced search from the same node. Null moves are disabled in the upper
+  // part of the verification subtree, otherwise we would just repeat the same null move search
+  const size_t savedMinIdepth = nullMoveMinIdepth_;
+  nullMoveMinIdepth_ = idepth + std::max<size_t>(3 * newDepth / 4, 1);
+  const score_t verifyScore = doSearch<NodeKind::Simple>(newDepth, idepth, beta - 1, beta, psq);
+  nullMoveMinIdepth_ = savedMinIdepth;
+  stack_[idepth].bestMove = Move::null();
+  return !mustStop() && verifyScore >= beta;
+}
+
+bool Searcher::tryProbCut(const size_t depth, const size_t idepth, const score_t beta,
+                          const PsqScore psq, const score_t staticScore) {
+  const int probBeta = static_cast<int>(beta) + PROBCUT_MARGIN;
+  if (depth < PROBCUT_MIN_DEPTH || probBeta >= SCORE_CHECKMATE_THRESHOLD ||
+      isScoreCheckmate(beta)) {
+    return false;
+  }
+  const score_t seeThreshold = std::max(probBeta - staticScore, 0);
+  Frame &frame = stack_[idepth];
+  QuiescenseMovePicker picker(board_, Move::null(), false);
+  for (Move move = picker.next(); move != Move::invalid(); move = picker.next()) {
+    if (!isSeeAtLeast(board_, move, seeThreshold)) {
+      continue;
+    }
+    const PsqScore newPsq = boardUpdatePsqScore(board_, move, psq);
+    const MovePersistence persistence = moveMake(board_, move);
+    if (!isMoveLegal(board_)) {
+      moveUnmake(board_, move, persistence);
+      continue;
+    }
+    if (!countNode()) {
+      moveUnmake(board_, move, persistence);
+      return false;
+    }
+    setMadeMove(idepth, move);
+    // Check with quiescence search first, as it's much cheaper
+    score_t score = -quiescenseSearch(idepth + 1, -probBeta, -probBeta + 1, newPsq);
+    if (score >= probBeta && !mustStop()) {
+      score = -search<NodeKind::Simple>(depth - PROBCUT_REDUCTION, idepth + 1, -probBeta,
+                                        -probBeta + 1, newPsq);
+    }
+    moveUnmake(board_, move, persistence);
+    if (mustStop()) {
+      return false;
+    }
+    if (score >= probBeta) {
+      frame.bestMove = move;
+      return true;
+    }
+  }
+  return false;
+}
+
+template <NodeKind Node, typename Picker>
+void Searcher::split(Picker &picker, const size_t depth, const size_t idepth, score_t &alpha,
+                     const score_t beta, const PsqScore psq) {
+  SplitPoint sp(board_, hashes_, prevMoves(idepth), activeSp_, Node, depth_, depth, idepth,
+                alpha, beta, psq);
+  for (Move move = picker.next(); move != Move::invalid(); move = picker.next()) {
+    if (move == Move::null()) {
+      continue;
+    }
+    if (move == stack_[idepth].excludedMove) {
+      continue;
+    }
+    if constexpr (Node == NodeKind::Root) {
+      sp.addMove(move, MovePickerStage::Start);
+    } else {
+      sp.addMove(move, picker.stage());
+    }
+  }
+
+  SplitPoint *const savedSp = activeSp_;
+  activeSp_ = &sp;
+  pool_->publish(sp);
+  searchSplitPoint<Node>(sp);
+  pool_->retract(sp);
+  waitHelpers(sp);
+  activeSp_ = savedSp;
+
+  Frame &frame = stack_[idepth];
+  if (sp.alpha() > alpha) {
+    alpha = sp.alpha();
+    frame.bestMove = sp.bestMove();
+  }
+  if constexpr (Node == NodeKind::Root) {
+    // Collect the results of the root moves, including the ones searched by the helpers
+    for (size_t i = 0; i < sp.moveCount(); ++i) {
+      rootMoves_.update(sp.move(i), sp.moveScore(i), sp.moveNodes(i));
+    }
+  }
+}
+
+template <NodeKind Node>
+void Searcher::searchSplitPoint(SplitPoint &sp) {
+  const size_t depth = sp.depth();
+  const size_t idepth = sp.idepth();
+  const score_t beta = sp.beta();
+  const PsqScore psq = sp.psq();
+  const bool inCheck = isCheck(board_);
+  const MoveHistory history = moveHistory(idepth);
+  Move move = Move::null();
+  MovePickerStage stage = MovePickerStage::Start;
+  size_t index = 0;
+  score_t alpha = 0;
+  while (sp.next(move, stage, index, alpha)) {
+    const PsqScore newPsq = boardUpdatePsqScore(board_, move, psq);
+    const MovePersistence persistence = moveMake(board_, move);
+    if (!isMoveLegal(board_)) {
+      moveUnmake(board_, move, persistence);
+      continue;
+    }
+    const uint64_t nodesBefore = nodes_;
+    if (!countNode()) {
+      moveUnmake(board_, move, persistence);
+      return;
+    }
+    setMadeMove(idepth, move);
+    const bool givesCheck = isCheck(board_);
+    // The first move in the node is searched by master before the split point is created
+    const size_t reduction =
+        isQuietMadeMove(stage, inCheck, givesCheck)
+            ? lmrReduction<Node>(depth, index + 1,
+                                 quietMoveScore(history, move, stack_[idepth].movePiece))
+            : 0;
+    const size_t extension = (givesCheck && canExtend(idepth, depth)) ? 1 : 0;
+    const score_t score =
+        searchMadeMove<Node>(depth + extension, idepth, alpha, beta, newPsq, false, reduction);
+    moveUnmake(board_, move, persistence);
+    if (mustStop()) {
+      return;
+    }
+    if (sp.update(index, move, score, nodes_ - nodesBefore)) {
+      updateOnCutoff<Node>(idepth, move, stage, depth, nullptr);
+      return;
+    }
+  }
+}
+
+void Searcher::waitHelpers(SplitPoint &sp) {
+  while (SplitPoint *child = pool_->joinBelow(sp)) {
+    // The state of this searcher is still needed to finish the current node, so use another one
+    Board board = child->board();
+    HashHistory hashes;
+    Searcher helper(job_, board, hashes, nodesLeft_);
+    helper.runSplitPoint(*child);
+    pool_->leave(*child);
+  }
+}
+
+void Searcher::runSplitPoint(SplitPoint &sp) {
+  board_ = sp.board();
+  hashes_ = sp.hashes();
+  depth_ = sp.rootDepth();
+  // Restore the previous moves, as the heuristics depend on them
+  const size_t idepth = sp.idepth();
+  for (size_t i = 0; i < CONTINUATION_PLIES && i < idepth; ++i) {
+    stack_[idepth - 1 - i].movePiece = sp.prevMoves()[i];
+  }
+  activeSp_ = &sp;
+  switch (sp.kind()) {
+    case NodeKind::Root: {
+      searchSplitPoint<NodeKind::Root>(sp);
+      break;
+    }
+    case NodeKind::Pv: {
+      searchSplitPoint<NodeKind::Pv>(sp);
+      break;
+    }
+    case NodeKind::Simple: {
+      searchSplitPoint<NodeKind::Simple>(sp);
+      break;
+    }
+  }
+  activeSp_ = nullptr;
+}
+
+template <NodeKind Node>
+score_t Searcher::doSearch(size_t depth, const size_t idepth, score_t alpha, score_t beta,
+                           const PsqScore psq) {
   const score_t origAlpha = alpha;
   const score_t origBeta = beta;
   Frame &frame = stack_[idepth];
@@ -211,12 +1037,29 @@ score_t Searcher::doSearch(const size_t depth, const size_t idepth, score_t alph
     return 0;
   }
 
-  // 1. Run quiescence search in leaf node
+  // 1. Mate distance pruning. Even if we checkmate right now, we cannot get the score better than
+  // the mate at the next ply, and we cannot be checkmated earlier than on the current ply
+  if constexpr (Node != NodeKind::Root) {
+    alpha = std::max(alpha, scoreCheckmateLose(static_cast<int16_t>(idepth)));
+    beta = std::min(beta, scoreCheckmateWin(static_cast<int16_t>(idepth + 1)));
+    if (alpha >= beta) {
+      return alpha;
+    }
+  }
+
+  // 2. Run quiescence search in leaf node
   if (depth == 0) {
-    return quiescenseSearch(alpha, beta, psq);
+    return quiescenseSearch(idepth, alpha, beta, psq);
   }
 
+  // The search with excluded move doesn't give the real score of the position, so its results
+  // must not be stored into the transposition table
+  const bool hasExcludedMove = (frame.excludedMove != Move::null());
+
   auto ttStore = [&](score_t score) {
+    if (hasExcludedMove) {
+      return;
+    }
     PositionCostBound bound = PositionCostBound::Exact;
     if (score <= origAlpha) {
       score = origAlpha;
@@ -230,18 +1073,20 @@ score_t Searcher::doSearch(const size_t depth, const size_t idepth, score_t alph
     tt_.store(board_.hash, TranspositionTable::Data(frame.bestMove, score, depth, bound));
   };
 
-  // 2. Probe the transposition table
+  // 3. Probe the transposition table
   Move hashMove = Move::null();
-  if (const TranspositionTable::Data data = tt_.load(board_.hash); data.isValid()) {
+  const TranspositionTable::Data ttData = tt_.load(board_.hash);
+  if (ttData.isValid()) {
     results_.inc(JobStat::TtHits);
-    hashMove = data.move();
-    if (Node == NodeKind::Simple && data.depth() >= depth && board_.moveCounter < 90) {
-      const score_t score = adjustCheckmate(data.score(), idepth);
-      switch (data.bound()) {
+    hashMove = ttData.move();
+    if (Node == NodeKind::Simple && !hasExcludedMove && ttData.depth() >= depth &&
+        board_.moveCounter < 90) {
+      const score_t score = adjustCheckmate(ttData.score(), idepth);
+      switch (ttData.bound()) {
         case PositionCostBound::Exact: {
           frame.bestMove = hashMove;
           // Refresh the hash entry, as it may come from older epoch
-          tt_.store(board_.hash, data);
+          tt_.store(board_.hash, ttData);
           return score;
         }
         case PositionCostBound::Lowerbound: {
@@ -260,67 +1105,202 @@ score_t Searcher::doSearch(const size_t depth, const size_t idepth, score_t alph
     }
   }
 
-  // 3. Iterate over the moves in the sorted order
-  auto picker = MovePickerFactory<Node>::create(jobId_, board_, hashMove, frame.killers, history_);
-  bool hasMove = false;
+  const bool inCheck = isCheck(board_);
+
+  // 4. Try to prune the node using static evaluation and null move
+  bool isFutile = false;
+  if constexpr (Node == NodeKind::Simple) {
+    if (!inCheck && !hasExcludedMove) {
+      const score_t staticScore = staticEvaluate(psq);
+      if (depth <= REVERSE_FUTILITY_MAX_DEPTH && !isScoreCheckmate(beta) &&
+          staticScore - REVERSE_FUTILITY_MARGIN * static_cast<int>(depth) >= beta) {
+        return beta;
+      }
+      if (depth <= RAZORING_MAX_DEPTH && !isScoreCheckmate(alpha) &&
+          staticScore + RAZORING_MARGIN[depth] <= alpha) {
+        const score_t score = quiescenseSearch(idepth, alpha, beta, psq);
+        if (mustStop()) {
+          return 0;
+        }
+        if (depth == 1 || score <= alpha) {
+          return score;
+        }
+      }
+      if (tryNullMove(depth, idepth, beta, psq, staticScore)) {
+        return mustStop() ? 0 : beta;
+      }
+      if (mustStop()) {
+        return 0;
+      }
+      if (tryProbCut(depth, idepth, beta, psq, staticScore)) {
+        ttStore(beta);
+        return beta;
+      }
+      if (mustStop()) {
+        return 0;
+      }
+      isFutile = depth <= FUTILITY_MAX_DEPTH && !isScoreCheckmate(alpha) &&
+                 staticScore + FUTILITY_MARGIN[depth] <= alpha;
+    }
+  }
+
+  // 5. Compensate for the missing hash move, as the move ordering is poor without it
+  if constexpr (Node != NodeKind::Root) {
+    if (hashMove == Move::null() && depth >= INTERNAL_ITERATIVE_MIN_DEPTH) {
+      switch (internalIterativeMode_) {
+        case InternalIterativeMode::None: {
+          break;
+        }
+        case InternalIterativeMode::Deepening: {
+          const size_t newDepth = (Node == NodeKind::Pv) ? depth - IID_PV_REDUCTION : depth / 2;
+          doSearch<Node>(newDepth, idepth, alpha, beta, psq);
+          if (mustStop()) {
+            return 0;
+          }
+          hashMove = frame.bestMove;
+          frame.bestMove = Move::null();
+          break;
+        }
+        case InternalIterativeMode::Reductions: {
+          depth -= IIR_REDUCTION;
+          break;
+        }
+      }
+    }
+  }
+
+  // 6. Check if the hash move is singular
+  size_t hashMoveExtension = 0;
+  if constexpr (Node != NodeKind::Root) {
+    if (depth >= SINGULAR_MIN_DEPTH && !hasExcludedMove && canExtend(idepth, depth) &&
+        hashMove != Move::null() && ttData.bound() != PositionCostBound::Upperbound &&
+        ttData.depth() + SINGULAR_TT_DEPTH_MARGIN >= depth) {
+      const score_t ttScore = adjustCheckmate(ttData.score(), idepth);
+      if (!isScoreCheckmate(ttScore)) {
+        const int singularBeta =
+            std::max<int>(ttScore - SINGULAR_MARGIN * static_cast<int>(depth),
+                          -SCORE_CHECKMATE_THRESHOLD + 1);
+        frame.excludedMove = hashMove;
+        const score_t score =
+            doSearch<NodeKind::Simple>(depth / 2, idepth, singularBeta - 1, singularBeta, psq);
+        frame.excludedMove = Move::null();
+        frame.bestMove = Move::null();
+        if (mustStop()) {
+          return 0;
+        }
+        if (score < singularBeta) {
+          hashMoveExtension = 1;
+        } else if (singularBeta >= beta) {
+          return beta;
+        }
+      }
+    }
+  }
+
+  // 7. Iterate over the moves in the sorted order
+  const MoveHistory history = moveHistory(idepth);
+  auto picker =
+      MovePickerFactory<Node>::create(rootMoves_, board_, hashMove, killers_[idepth], history);
+  size_t moveIndex = 0;
+  FailedMoves failed;
   for (Move move = picker.next(); move != Move::invalid(); move = picker.next()) {
-    if (move == Move::null()) {
+    if (move == Move::null() || move == frame.excludedMove) {
       continue;
     }
-    const score_pair_t newPsq = boardUpdatePsqScore(board_, move, psq);
+    const PsqScore newPsq = boardUpdatePsqScore(board_, move, psq);
     const MovePersistence persistence = moveMake(board_, move);
     if (!isMoveLegal(board_)) {
       moveUnmake(board_, move, persistence);
       continue;
     }
-    results_.inc(JobStat::Nodes);
-    if (hasMove &&
-        -search<NodeKind::Simple>(depth - 1, idepth + 1, -alpha - 1, -alpha, newPsq) <= alpha) {
-      moveUnmake(board_, move, persistence);
-      if (mustStop()) {
-        return 0;
+    const bool givesCheck = isCheck(board_);
+    bool isQuiet = false;
+    if constexpr (Node != NodeKind::Root) {
+      isQuiet = isQuietMadeMove(picker.stage(), inCheck, givesCheck);
+    }
+    if constexpr (Node == NodeKind::Simple) {
+      // Skip the quiet moves which are unlikely to improve alpha
+      if (isQuiet && moveIndex != 0 && alpha > -SCORE_CHECKMATE_THRESHOLD &&
+          (isFutile || (depth <= MOVE_COUNT_PRUNING_MAX_DEPTH &&
+                        moveIndex >= MOVE_COUNT_PRUNING_LIMIT[depth]))) {
+        moveUnmake(board_, move, persistence);
+        ++moveIndex;
+        continue;
       }
-      continue;
     }
-    hasMove = true;
-    constexpr NodeKind newNode = (Node == NodeKind::Simple ? NodeKind::Simple : NodeKind::Pv);
-    const score_t score = -search<newNode>(depth - 1, idepth + 1, -beta, -alpha, newPsq);
+    const uint64_t nodesBefore = nodes_;
+    if (!countNode()) {
+      moveUnmake(board_, move, persistence);
+      return 0;
+    }
+    setMadeMove(idepth, move);
+    const size_t reduction =
+        isQuiet
+            ? lmrReduction<Node>(depth, moveIndex, quietMoveScore(history, move, frame.movePiece))
+            : 0;
+    size_t extension = (givesCheck && canExtend(idepth, depth)) ? 1 : 0;
+    if (move == hashMove) {
+      extension = std::max(extension, hashMoveExtension);
+    }
+    const score_t score = searchMadeMove<Node>(depth + extension, idepth, alpha, beta, newPsq,
+                                               moveIndex == 0, reduction);
+    ++moveIndex;
     moveUnmake(board_, move, persistence);
     if (mustStop()) {
       return 0;
     }
+    if constexpr (Node == NodeKind::Root) {
+      rootMoves_.update(move, score > alpha ? score : -SCORE_INF, nodes_ - nodesBefore);
+    }
     if (score > alpha) {
       alpha = score;
       frame.bestMove = move;
     }
     if (alpha >= beta) {
       if constexpr (Node != NodeKind::Root) {
-        if (picker.stage() >= MovePickerStage::Killer) {
-          frame.killers.add(move);
-          history_[move] += depth * depth;
-        }
+        updateOnCutoff<Node>(idepth, move, picker.stage(), depth, &failed);
       }
       ttStore(beta);
       return beta;
     }
+    if constexpr (Node != NodeKind::Root) {
+      failed.add(move, picker.stage());
+    }
+
+    // The first move is searched, so the remaining ones may be searched in parallel
+    if (canSplit(depth)) {
+      split<Node>(picker, depth, idepth, alpha, beta, psq);
+      if (mustStop()) {
+        return 0;
+      }
+      if (alpha >= beta) {
+        ttStore(beta);
+        return beta;
+      }
+      break;
+    }
   }
 
-  // 4. Detect checkmate and stalemate
-  if (!hasMove) {
-    return isCheck(board_) ? scoreCheckmateLose(idepth) : 0;
+  // 8. Detect checkmate and stalemate. If the only legal move is excluded, then it's singular, so
+  // we just fail low
+  if (moveIndex == 0) {
+    if (hasExcludedMove) {
+      return alpha;
+    }
+    return inCheck ? scoreCheckmateLose(idepth) : 0;
   }
 
-  // 5. End of search
+  // 9. End of search
   ttStore(alpha);
   return alpha;
 }
 
 std::vector<Move> unwindPv(Board board, const Move bestMove, const TranspositionTable &tt) {
-  RepetitionTable repetitions;
-  repetitions.insert(board.hash);
+  // The PV is short, so a linear search over the visited positions is enough to detect a cycle
+  std::vector<board_hash_t> visited{board.hash};
   std::vector<Move> pv{bestMove};
   moveMake(board, bestMove);
-  repetitions.insert(board.hash);
+  visited.push_back(board.hash);
   for (;;) {
     TranspositionTable::Data data = tt.load(board.hash);
     if (!data.isValid() || data.move() == Move::null() ||
@@ -329,45 +1309,176 @@ std::vector<Move> unwindPv(Board board, const Move bestMove, const Transposition
     }
     const Move move = data.move();
     moveMake(board, move);
-    if (!repetitions.insert(board.hash)) {
+    if (std::find(visited.begin(), visited.end(), board.hash) != visited.end()) {
       break;
     }
+    visited.push_back(board.hash);
     pv.push_back(move);
   }
   return pv;
 }
 
+void Job::prepareTables(const Board &root) {
+  // The tables are created by the job thread, so they are allocated on its local NUMA node
+  const size_t rootPly = gamePly(root);
+  if (tables_) {
+    tables_->age(rootPly);
+  } else {
+    tables_ = std::make_unique<OrderingTables>();
+    tables_->rootPly = rootPly;
+  }
+}
+
 void Job::run(const Position &position, const SearchLimits &limits) {
-  // Apply moves and fill repetition tables
-  Board board = position.first;
-  RepetitionTable singleRepeat;
-  RepetitionTable doubleRepeat;
-  for (const Move move : position.moves) {
-    if (!singleRepeat.insert(board.hash)) {
-      doubleRepeat.insert(board.hash);
+  prepareTables(position.last);
+
+  // Take the prepared root state. The copies are needed, as the search modifies them
+  Board board = position.last;
+  HashHistory hashes = position.hashes;
+
+  // Returns the aspiration window bound which is `delta` away from `score`. If the bound falls into
+  // checkmate scores, the window becomes unbounded on this side
+  auto windowBound = [](const score_t score, const int delta) -> score_t {
+    const int bound = static_cast<int>(score) + delta;
+    if (bound <= -SCORE_CHECKMATE_THRESHOLD) {
+      return -SCORE_INF;
     }
-    moveMake(board, move);
+    if (bound >= SCORE_CHECKMATE_THRESHOLD) {
+      return SCORE_INF;
+    }
+    return bound;
+  };
+
+  // When searching for checkmate, only the scores which denote checkmate in at most `limits.mate`
+  // moves are interesting, so we use the score just below such checkmate as alpha. Together with
+  // mate distance pruning, this cuts off all the lines which are longer than needed
+  const bool isMateSearch = (limits.mate != MATE_NONE);
+  score_t mateAlpha = -SCORE_INF;
+  if (isMateSearch) {
+    const size_t matePlies = 2 * std::min(limits.mate, MAX_DEPTH) - 1;
+    mateAlpha = scoreCheckmateWin(static_cast<int16_t>(matePlies)) - 1;
   }
 
-  // Perform iterative deepening
-  Searcher searcher(*this, board, limits, doubleRepeat);
+  // Perform iterative deepening. In multi-PV mode, each iteration searches several lines one after
+  // another, and each line excludes the best moves of the previous ones. Mate search always looks
+  // for a single line
+  Searcher searcher(*this, board, hashes, limits.nodes);
+  searcher.initRootMoves();
+  const size_t lineCount =
+      isMateSearch ? 1 : std::max<size_t>(std::min(multiPv_, searcher.rootMoveCount()), 1);
+  // Returns the index of the line `line` to report to the server
+  auto lineIndex = [&](const size_t line) -> size_t { return lineCount == 1 ? 0 : line + 1; };
+  std::vector<score_t> prevScores(lineCount, 0);
+  std::vector<Move> bestMoves(lineCount, Move::null());
+  std::vector<score_t> scores(lineCount, 0);
   const size_t maxDepth = std::min(limits.depth, MAX_DEPTH);
   for (size_t depth = 1; depth <= maxDepth; ++depth) {
-    Move bestMove = Move::null();
-    const score_t score = searcher.run(depth, bestMove);
-    if (communicator_.isStopped()) {
-      return;
+    bool isAborted = false;
+    bool isMateFound = true;
+    double bestMoveNodeFraction = 0.0;
+    for (size_t line = 0; line < lineCount && !isAborted; ++line) {
+      // Search with aspiration window around the score from the previous iteration. If the score
+      // falls outside the window, widen it and search again. In mate search, the first iteration is
+      // done with full window, so we have some best move even if no checkmate is found
+      const score_t prevScore = prevScores[line];
+      int lowDelta = ASPIRATION_INITIAL_DELTA;
+      int highDelta = ASPIRATION_INITIAL_DELTA;
+      const bool useMateWindow = isMateSearch && depth > 1;
+      const bool useWindow =
+          !useMateWindow && depth >= ASPIRATION_MIN_DEPTH && !isScoreCheckmate(prevScore);
+      score_t alpha = useWindow ? windowBound(prevScore, -lowDelta) : -SCORE_INF;
+      score_t beta = useWindow ? windowBound(prevScore, highDelta) : SCORE_INF;
+      if (useMateWindow) {
+        alpha = mateAlpha;
+      }
+      Move bestMove = Move::null();
+      score_t score = 0;
+      for (bool isResearch = false;; isResearch = true) {
+        score = searcher.run(depth, line, alpha, beta, isResearch, bestMove);
+        if (communicator_.isStopped() || searcher.isOutOfNodes()) {
+          return;
+        }
+        if (communicator_.depth() != depth) {
+          // Another job has already finished this depth, so the search was aborted
+          isAborted = true;
+          break;
+        }
+        if (useMateWindow) {
+          break;
+        }
+        if (score <= alpha && alpha != -SCORE_INF) {
+          if (id_ == 0) {
+            server_.sendResult({depth, nullptr, 0, scoreToPositionCost(alpha),
+                                PositionCostBound::Upperbound, lineIndex(line)});
+          }
+          lowDelta *= ASPIRATION_WIDEN_FACTOR;
+          alpha = windowBound(prevScore, -lowDelta);
+          continue;
+        }
+        if (score >= beta && beta != SCORE_INF) {
+          if (id_ == 0) {
+            std::vector<Move> pv = unwindPv(board, bestMove, table_);
+            server_.sendResult({depth, pv.data(), pv.size(), scoreToPositionCost(beta),
+                                PositionCostBound::Lowerbound, lineIndex(line)});
+          }
+          highDelta *= ASPIRATION_WIDEN_FACTOR;
+          beta = windowBound(prevScore, highDelta);
+          continue;
+        }
+        break;
+      }
+      if (isAborted) {
+        break;
+      }
+      if (useMateWindow && score <= alpha) {
+        // No checkmate is found on this depth, so there is no best move to report
+        isMateFound = false;
+        break;
+      }
+      if (line == 0) {
+        bestMoveNodeFraction = searcher.bestMoveNodeFraction();
+      }
+      searcher.finishLine(line, bestMove);
+      prevScores[line] = score;
+      bestMoves[line] = bestMove;
+      scores[line] = score;
+    }
+    if (isAborted) {
+      continue;
+    }
+    if (!isMateFound) {
+      communicator_.finishDepth(depth);
+      continue;
     }
     if (communicator_.finishDepth(depth)) {
       // FIXME: check that best move is not null and score is valid
-      results_.setBestMove(depth, bestMove);
-      std::vector<Move> pv = unwindPv(board, bestMove, table_);
-      server_.sendResult(
-          {depth, pv.data(), pv.size(), scoreToPositionCost(score), PositionCostBound::Exact});
+      results_.setBestMove(depth, bestMoves[0]);
+      for (size_t line = 0; line < lineCount; ++line) {
+        std::vector<Move> pv = unwindPv(board, bestMoves[line], table_);
+        server_.sendResult({depth, pv.data(), pv.size(), scoreToPositionCost(scores[line]),
+                            PositionCostBound::Exact, lineIndex(line)});
+      }
+      if (timeManager_.finishIteration(depth, bestMoves[0], scores[0], bestMoveNodeFraction)) {
+        break;
+      }
+      if (isMateSearch && scores[0] > mateAlpha) {
+        break;
+      }
     }
   }
 
   communicator_.stop();
 }
 
+void Job::runHelper(const Position &position, const SearchLimits &limits) {
+  prepareTables(position.last);
+  Board board = Board::initialPosition();
+  HashHistory hashes;
+  Searcher searcher(*this, board, hashes, limits.nodes);
+  while (SplitPoint *sp = pool_->join()) {
+    searcher.runSplitPoint(*sp);
+    pool_->leave(*sp);
+  }
+}
+
 }  // namespace SoFSearch::Private
@@ -5,14 +5,18 @@
 #include <chrono>
 #include <condition_variable>
 #include <cstdint>
+#include <memory>
 #include <mutex>
 
 #include "bot_api/server.h"
 #include "core/board.h"
 #include "core/move.h"
 #include "search/private/limits.h"
+#include "search/private/split_point.h"
+#include "search/private/time_manager.h"
 #include "search/private/transposition_table.h"
 #include "search/private/types.h"
+#include "search/private/util.h"
 
 namespace SoFSearch::Private {
 
@@ -22,19 +26,29 @@ public:
   // Tells all the jobs that they must stop the search
   void stop();
 
-  // Waits until `stop()` is called or time period `time` is expired. If `stop()` was called before
-  // or during waiting, returns `true`. Note that this function may sometimes return before `time`
-  // is expired.
-  template <class Rep, class Period>
-  bool wait(const std::chrono::duration<Rep, Period> time) {
+  // Waits until `stop()` or `wake()` is called or time point `time` is reached. If `stop()` was
+  // called before or during waiting, returns `true`. Note that this function may sometimes return
+  // before `time` is reached.
+  template <class Clock, class Duration>
+  bool waitUntil(const std::chrono::time_point<Clock, Duration> time) {
     std::unique_lock lock(stopLock_);
-    if (isStopped()) {
-      return true;
+    if (!isStopped() && !woken_) {
+      stopEvent_.wait_until(lock, time);
     }
-    stopEvent_.wait_for(lock, time);
+    woken_ = false;
     return isStopped();
   }
 
+  // Makes the current or the next call of `waitUntil()` return without stopping the jobs. This is
+  // used to tell the waiting thread that the time limits were changed
+  inline void wake() {
+    {
+      std::unique_lock lock(stopLock_);
+      woken_ = true;
+    }
+    stopEvent_.notify_all();
+  }
+
   // Returns `true` if the jobs must stop the search
   inline bool isStopped() const { return stopped_.load(std::memory_order_relaxed); }
 
@@ -45,6 +59,39 @@ public:
   inline void reset() {
     depth_.store(1, std::memory_order_relaxed);
     stopped_.store(false, std::memory_order_relaxed);
+    woken_ = false;
+    ownBudgets_ = 0;
+    exhaustedBudgets_.store(0, std::memory_order_relaxed);
+    sharedNodesLeft_.store(NODES_UNLIMITED, std::memory_order_relaxed);
+  }
+
+  // Sets the number of jobs which have their own node budgets. The search is stopped only when all
+  // of them exhaust their budgets. Must be called before the jobs are started
+  inline void setOwnBudgets(const size_t count) { ownBudgets_ = count; }
+
+  // Sets the node budget which is shared by all the jobs. Must be called before the jobs are
+  // started
+  inline void setSharedBudget(const uint64_t nodes) {
+    sharedNodesLeft_.store(nodes, std::memory_order_relaxed);
+  }
+
+  // Indicates that one of the jobs has exhausted its own node budget. Stops the search if it was
+  // the last job with non-exhausted budget
+  inline void exhaustOwnBudget() {
+    if (exhaustedBudgets_.fetch_add(1, std::memory_order_relaxed) + 1 == ownBudgets_) {
+      stop();
+    }
+  }
+
+  // Takes one node from the shared node budget. Returns `false` if the budget is exhausted
+  inline bool takeSharedNode() {
+    uint64_t left = sharedNodesLeft_.load(std::memory_order_relaxed);
+    do {
+      if (left == 0) {
+        return false;
+      }
+    } while (!sharedNodesLeft_.compare_exchange_weak(left, left - 1, std::memory_order_relaxed));
+    return true;
   }
 
   // Indicates that the job has finished to search on depth `depth`. Returns `true` if it was the
@@ -54,9 +101,13 @@ public:
 private:
   std::atomic<size_t> depth_ = 1;
   std::atomic<size_t> stopped_ = false;
+  size_t ownBudgets_ = 0;
+  std::atomic<size_t> exhaustedBudgets_ = 0;
+  std::atomic<uint64_t> sharedNodesLeft_ = NODES_UNLIMITED;
 
   std::condition_variable stopEvent_;
   std::mutex stopLock_;
+  bool woken_ = false;  // Guarded by `stopLock_`
 };
 
 // Type of job stats
@@ -69,9 +120,15 @@ enum class JobStat : size_t {
 // Number of job stats
 constexpr size_t JOB_STAT_SZ = static_cast<size_t>(JobStat::Max);
 
+// Size of the CPU cache line
+constexpr size_t CACHE_LINE_SIZE = 64;
+
 // Job results and statistics. This class is thread-safe if there is no more than one writer thread.
 // If two threads write concurrently, the data race occurs.
-class JobResults {
+//
+// The class is aligned to cache line size, so the results of different jobs never share the same
+// cache line, which is written on every node.
+class alignas(CACHE_LINE_SIZE) JobResults {
 public:
   // These functions return the job results. They can be called by reader threads.
   inline uint64_t get(const JobStat stat) const {
@@ -111,23 +168,57 @@ static_assert(std::atomic<SoFCore::Move>::is_always_lock_free);
 // A class that represents a single search job.
 class Job {
 public:
+  // If `pool` is not null, the job performs young brothers wait search and shares its work with the
+  // helpers via `pool`. Otherwise, the job performs lazy SMP search and doesn't share any work.
+  // `multiPv` is the number of best lines to search and report. `tables` hold the move ordering
+  // tables of this job, which persist between the searches in the same game. If `tables` is null,
+  // the job creates new ones.
   inline Job(JobCommunicator &communicator, TranspositionTable &table, SoFBotApi::Server &server,
-             size_t id)
-      : communicator_(communicator), table_(table), server_(server), id_(id) {}
+             TimeManager &timeManager, SplitPointPool *pool,
+             InternalIterativeMode internalIterativeMode, size_t multiPv,
+             std::unique_ptr<OrderingTables> &tables, size_t id)
+      : communicator_(communicator),
+        table_(table),
+        server_(server),
+        timeManager_(timeManager),
+        pool_(pool),
+        internalIterativeMode_(internalIterativeMode),
+        multiPv_(multiPv),
+        tables_(tables),
+        id_(id) {}
 
   // Returns the current results of the search job. The results are updated while the job is
   // running.
   inline const JobResults &results() const { return results_; }
 
-  // Starts the search job. This function must be called exactly once.
+  // Starts the search job. This function must be called exactly once. In lazy SMP mode, the node
+  // limit in `limits` is the own node budget of this job. When the job exhausts it, the job stops,
+  // while the other jobs continue to search. In young brothers wait mode, all the jobs take the
+  // nodes from the budget shared via `JobCommunicator`, and the node limit in `limits` must be the
+  // same as this budget.
   void run(const Position &position, const SearchLimits &limits);
 
+  // Starts the job as a young brothers wait helper. The helper doesn't perform iterative deepening
+  // by itself, but joins the split points from the pool and searches the moves there until the pool
+  // is shut down. This function must be called exactly once, and the job must have a non-null pool.
+  // `position` is the root position of the search.
+  void runHelper(const Position &position, const SearchLimits &limits);
+
 private:
   friend class Searcher;
 
+  // Ages the move ordering tables from the previous search, or creates them if there are none.
+  // `root` is the root position of the new search
+  void prepareTables(const SoFCore::Board &root);
+
   JobCommunicator &communicator_;
   TranspositionTable &table_;
   SoFBotApi::Server &server_;
+  TimeManager &timeManager_;
+  SplitPointPool *pool_;
+  InternalIterativeMode internalIterativeMode_;
+  size_t multiPv_;
+  std::unique_ptr<OrderingTables> &tables_;
   size_t id_;
   JobResults results_;
 };
@@ -1,7 +1,9 @@
 #include "search/private/job_runner.h"
 
+#include <algorithm>
 #include <chrono>
 #include <deque>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -9,6 +11,7 @@
 #include "core/board.h"
 #include "core/move.h"
 #include "core/movegen.h"
+#include "util/affinity.h"
 #include "util/defer.h"
 #include "util/logging.h"
 #include "util/random.h"
@@ -64,6 +67,7 @@ void JobRunner::hashResize(const size_t size) {
 void JobRunner::join() {
   if (mainThread_.joinable()) {
     comm_.stop();
+    finishPondering();
     mainThread_.join();
   }
 }
@@ -85,8 +89,71 @@ static Move pickRandomMove(Board board) {
   return Move::null();
 }
 
+// Returns the expected reply to `bestMove` stored in the transposition table, or null move if
+// there is no such reply
+static Move findPonderMove(Board board, const Move bestMove, const TranspositionTable &tt) {
+  if (bestMove == Move::null()) {
+    return Move::null();
+  }
+  moveMake(board, bestMove);
+  const TranspositionTable::Data data = tt.load(board.hash);
+  if (!data.isValid()) {
+    return Move::null();
+  }
+  const Move move = data.move();
+  if (move == Move::null() || !move.isWellFormed(board.side) || !isMoveValid(board, move)) {
+    return Move::null();
+  }
+  moveMake(board, move);
+  return isMoveLegal(board) ? move : Move::null();
+}
+
+std::vector<std::vector<size_t>> JobRunner::placeJobs(const size_t numJobs,
+                                                      const ThreadBinding binding) {
+  std::vector<std::vector<size_t>> placement(numJobs);
+  if (binding == ThreadBinding::None) {
+    return placement;
+  }
+  if (!isNumaDetected_) {
+    numaNodes_ = SoFUtil::cpuNumaNodes();
+    isNumaDetected_ = true;
+    if (numaNodes_.empty()) {
+      logWarn(JOB_RUNNER) << "Thread binding is not supported on this platform";
+    }
+  }
+
+  // Interleave the CPUs from different nodes, so the consecutive jobs land on different nodes
+  std::vector<std::pair<size_t, size_t>> order;  // Pairs of (node, CPU)
+  for (size_t i = 0;; ++i) {
+    const size_t oldSize = order.size();
+    for (size_t node = 0; node < numaNodes_.size(); ++node) {
+      if (i < numaNodes_[node].size()) {
+        order.emplace_back(node, numaNodes_[node][i]);
+      }
+    }
+    if (order.size() == oldSize) {
+      break;
+    }
+  }
+  if (order.empty()) {
+    return placement;
+  }
+
+  for (size_t i = 0; i < numJobs; ++i) {
+    const auto [node, cpu] = order[i % order.size()];
+    if (binding == ThreadBinding::Cores) {
+      placement[i] = {cpu};
+    } else {
+      placement[i] = numaNodes_[node];
+    }
+  }
+  return placement;
+}
+
 void JobRunner::runMainThread(const Position &position, const SearchLimits &limits,
-                              const size_t numJobs) {
+                              const JobRunnerParams &params,
+                              const steady_clock::time_point startTime) {
+  const size_t numJobs = params.numJobs;
   {
     std::unique_lock lock(hashChangeLock_);
     canChangeHash_ = false;
@@ -102,50 +169,126 @@ void JobRunner::runMainThread(const Position &position, const SearchLimits &limi
 
   // Create jobs and associated threads. We store the jobs in `deque` instead of `vector`, as `Job`
   // instances are not moveable
+  const bool isYbw = (params.parallelMode == ParallelMode::YoungBrothersWait && numJobs > 1);
   std::deque<Job> jobs;
   for (size_t i = 0; i < numJobs; ++i) {
-    jobs.emplace_back(comm_, tt_, server_, i);
+    jobs.emplace_back(comm_, tt_, server_, timeManager_, isYbw ? &pool_ : nullptr,
+                      params.internalIterativeMode, params.multiPv, tables_[i], i);
+  }
+  // Each thread binds itself before the job starts, so the job allocates its search state (which
+  // includes the stack frames and the history tables) on the local NUMA node
+  const std::vector<std::vector<size_t>> placement = placeJobs(numJobs, params.threadBinding);
+  // In lazy SMP mode, split the node limit between the jobs, so the total number of nodes never
+  // exceeds it. Each job stops when it exhausts its own budget, and the search stops when all of
+  // them do. In young brothers wait mode, the master searches the top of the tree alone, so its
+  // fixed share would run out long before the helpers' ones. Thus, the jobs share a single budget
+  std::vector<SearchLimits> jobLimits(numJobs, limits);
+  if (limits.nodes != NODES_UNLIMITED) {
+    if (isYbw) {
+      comm_.setSharedBudget(limits.nodes);
+    } else {
+      comm_.setOwnBudgets(numJobs);
+      for (size_t i = 0; i < numJobs; ++i) {
+        jobLimits[i].nodes = limits.nodes / numJobs + (i < limits.nodes % numJobs ? 1 : 0);
+      }
+    }
   }
+  std::atomic<bool> bindFailed = false;
   std::vector<std::thread> threads;
   for (size_t i = 0; i < numJobs; ++i) {
-    threads.emplace_back([&job = jobs[i], &position, &limits]() { job.run(position, limits); });
+    threads.emplace_back([&job = jobs[i], &cpus = placement[i], &bindFailed, &position,
+                          &jobLimit = jobLimits[i], isHelper = (isYbw && i != 0)]() {
+      if (!cpus.empty() && !SoFUtil::threadBindToCpus(cpus)) {
+        bindFailed.store(true, std::memory_order_relaxed);
+      }
+      if (isHelper) {
+        job.runHelper(position, jobLimit);
+      } else {
+        job.run(position, jobLimit);
+      }
+    });
   }
 
   static constexpr auto STATS_UPDATE_INTERVAL = 3s;
-  static constexpr auto THREAD_TICK_INTERVAL = 30ms;
 
-  // Run loop in which we check the jobs' status
-  const auto startTime = steady_clock::now();
-  auto statsLastUpdatedTime = startTime;
-  do {
-    const auto now = steady_clock::now();
-
-    // Collect stats
+  auto collectStats = [&]() {
     Stats stats;
     for (const Job &job : jobs) {
       stats.add(job.results());
     }
+    return stats;
+  };
+
+  // Returns the time point when the search must be stopped. While pondering, the time is not
+  // counted, and after ponderhit, it's counted from the moment of ponderhit
+  auto getDeadline = [&]() {
+    std::unique_lock lock(ponderLock_);
+    return (isPondering_ || limits.time == TIME_UNLIMITED) ? steady_clock::time_point::max()
+                                                           : clockStartTime_ + limits.time;
+  };
 
-    // Check if it's time to stop
-    if (stats.nodes() > limits.nodes ||
-        (limits.time != TIME_UNLIMITED && now - startTime > limits.time)) {
+  // Run loop in which we check the jobs' status. This thread also acts as a watchdog for the time
+  // limit: it sleeps until the exact deadline and stops the jobs when it's reached, so the jobs
+  // don't need to query the clock themselves. Ponderhit wakes this thread, as the deadline changes
+  auto deadline = getDeadline();
+  auto statsLastUpdatedTime = startTime;
+  for (;;) {
+    const auto now = steady_clock::now();
+    deadline = getDeadline();
+
+    // Check if it's time to stop. Node limit is not checked here, as the jobs track their node
+    // budgets by themselves
+    if (now >= deadline) {
       comm_.stop();
     }
 
     // Print stats
     if (now >= statsLastUpdatedTime + STATS_UPDATE_INTERVAL) {
+      const Stats stats = collectStats();
       server_.sendNodeCount(stats.nodes());
       server_.sendHashHits(stats.ttHits());
       while (now >= statsLastUpdatedTime + STATS_UPDATE_INTERVAL) {
         statsLastUpdatedTime += STATS_UPDATE_INTERVAL;
       }
     }
-  } while (!comm_.wait(THREAD_TICK_INTERVAL));
 
-  // Join job threads
+    // Sleep until the next event which requires our attention
+    if (comm_.waitUntil(std::min(deadline, statsLastUpdatedTime + STATS_UPDATE_INTERVAL))) {
+      break;
+    }
+  }
+
+  // The jobs may finish the search while pondering (e.g. if the depth limit is reached), but the
+  // best move must not be reported until ponderhit or stop
+  {
+    std::unique_lock lock(ponderLock_);
+    ponderEvent_.wait(lock, [&]() { return !isPondering_; });
+  }
+
+  // Find out when the stop was requested, to measure how fast we react on it. If the search was not
+  // stopped externally, the deadline is used instead
+  std::optional<steady_clock::time_point> stopTime;
+  if (const auto ticks = stopRequestTime_.load(std::memory_order_relaxed); ticks != 0) {
+    stopTime = steady_clock::time_point(steady_clock::duration(ticks));
+  } else if (steady_clock::now() >= deadline) {
+    stopTime = deadline;
+  }
+
+  // Wake up the helpers which wait for split points, then join job threads
+  pool_.shutdown();
   for (std::thread &thread : threads) {
     thread.join();
   }
+  if (bindFailed.load(std::memory_order_relaxed)) {
+    logWarn(JOB_RUNNER) << "Some search threads could not be bound to their CPUs";
+  }
+
+  // Display final stats, so the exact number of nodes searched is known
+  {
+    const Stats stats = collectStats();
+    server_.sendNodeCount(stats.nodes());
+    server_.sendHashHits(stats.ttHits());
+  }
 
   // Display best move
   size_t bestDepth = 0;
@@ -163,18 +306,71 @@ void JobRunner::runMainThread(const Position &position, const SearchLimits &limi
     }
     bestMove = pickRandomMove(position.last);
   }
-  server_.finishSearch(bestMove);
+  if (stopTime && isDebugMode()) {
+    const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+        steady_clock::now() - *stopTime);
+    server_.sendString("stop latency " + std::to_string(latency.count()) + " us");
+  }
+  server_.finishSearch(bestMove, findPonderMove(position.last, bestMove, tt_));
 }
 
-void JobRunner::start(const Position &position, const SearchLimits &limits, const size_t numJobs) {
+void JobRunner::start(const Position &position, const SearchLimits &limits,
+                      const JobRunnerParams &params, const bool isPondering) {
   join();
   comm_.reset();
+  pool_.reset();
+  if (clearTables_) {
+    tables_.clear();
+    clearTables_ = false;
+  }
+  tables_.resize(params.numJobs);
+  stopRequestTime_.store(0, std::memory_order_relaxed);
   tt_.nextEpoch();
-  mainThread_ = std::thread(
-      [this, position, limits, numJobs]() { runMainThread(position, limits, numJobs); });
+  // Measure the search time from here, as the main thread may need some time to start
+  const auto startTime = steady_clock::now();
+  {
+    std::unique_lock lock(ponderLock_);
+    isPondering_ = isPondering;
+    clockStartTime_ = startTime;
+  }
+  timeManager_.start(limits, startTime, isPondering);
+  mainThread_ = std::thread([this, position, limits, params, startTime]() {
+    runMainThread(position, limits, params, startTime);
+  });
+}
+
+void JobRunner::stop() {
+  // Remember only the first stop request, as the subsequent ones don't make the search stop faster
+  steady_clock::rep expected = 0;
+  stopRequestTime_.compare_exchange_strong(expected, steady_clock::now().time_since_epoch().count(),
+                                           std::memory_order_relaxed);
+  comm_.stop();
+  finishPondering();
 }
 
-void JobRunner::stop() { comm_.stop(); }
+bool JobRunner::ponderHit() {
+  const auto now = steady_clock::now();
+  {
+    std::unique_lock lock(ponderLock_);
+    if (!isPondering_) {
+      return false;
+    }
+    isPondering_ = false;
+    clockStartTime_ = now;
+  }
+  timeManager_.ponderHit(now);
+  ponderEvent_.notify_all();
+  comm_.wake();
+  return true;
+}
+
+void JobRunner::finishPondering() {
+  {
+    std::unique_lock lock(ponderLock_);
+    isPondering_ = false;
+  }
+  ponderEvent_.notify_all();
+}
 
 JobRunner::~JobRunner() { join(); }
 
@@ -2,17 +2,54 @@
 #define SOF_SEARCH_PRIVATE_JOB_RUNNER_INCLUDED
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <thread>
+#include <vector>
 
 #include "bot_api/server.h"
 #include "search/private/job.h"
 #include "search/private/limits.h"
+#include "search/private/split_point.h"
+#include "search/private/time_manager.h"
 #include "search/private/transposition_table.h"
 #include "search/private/types.h"
+#include "search/private/util.h"
 
 namespace SoFSearch::Private {
 
+// Algorithm used to run the search in multiple threads
+enum class ParallelMode {
+  // Each job performs its own iterative deepening, and the jobs communicate only via the shared
+  // transposition table
+  LazySmp,
+  // Only the first job performs iterative deepening, and the remaining jobs help it to search the
+  // split points (see `SplitPoint` for more details)
+  YoungBrothersWait
+};
+
+// Policy of placing the job threads on CPUs
+enum class ThreadBinding {
+  // The threads are placed by the operating system
+  None,
+  // Each thread is bound to a NUMA node, and the threads are distributed evenly among the nodes
+  NumaNodes,
+  // Each thread is bound to a single logical CPU, and the threads are distributed evenly among NUMA
+  // nodes
+  Cores
+};
+
+// Parameters which control how the jobs are run
+struct JobRunnerParams {
+  size_t numJobs = 1;
+  ParallelMode parallelMode = ParallelMode::LazySmp;
+  ThreadBinding threadBinding = ThreadBinding::None;
+  InternalIterativeMode internalIterativeMode = InternalIterativeMode::None;
+  size_t multiPv = 1;
+};
+
 // The class that runs multiple search jobs simultaneously and controls them.
 class JobRunner {
 public:
@@ -29,13 +66,25 @@ public:
   void join();
 
   // Starts the search. If the search is already started, the previous search is stopped in a
-  // blocked manner (i.e. by calling `join()`)
-  void start(const Position &position, const SearchLimits &limits, size_t numJobs);
+  // blocked manner (i.e. by calling `join()`). If `isPondering` is `true`, the search starts in
+  // ponder mode: the time limits are not applied, and the best move is not reported until
+  // `ponderHit()` or `stop()` is called
+  void start(const Position &position, const SearchLimits &limits, const JobRunnerParams &params,
+             bool isPondering);
+
+  // Switches the running search from ponder mode to the normal one. The search keeps all its
+  // state, and the time limits are counted from this moment. Returns `false` if the search is not
+  // in ponder mode
+  bool ponderHit();
 
   // Indicates that the hash table size (in bytes) must be changed to `size`. The resize operation
   // may be deferred until the search is stopped.
   void hashResize(size_t size);
 
+  // Indicates that a new game is started, so the move ordering tables from the previous searches
+  // must be discarded. The operation is deferred until the next search is started.
+  inline void newGame() { clearTables_ = true; }
+
   // Indicates that the hash table must be cleared. The clear operation may be deferred until the
   // search is stopped.
   void hashClear();
@@ -50,13 +99,37 @@ public:
 
 private:
   // Main function of the thread which controls all the running jobs.
-  void runMainThread(const Position &position, const SearchLimits &limits, size_t numJobs);
+  void runMainThread(const Position &position, const SearchLimits &limits,
+                     const JobRunnerParams &params,
+                     std::chrono::steady_clock::time_point startTime);
+
+  // Returns the list of CPUs to bind each of `numJobs` job threads. Empty list for the thread means
+  // that it must not be bound
+  std::vector<std::vector<size_t>> placeJobs(size_t numJobs, ThreadBinding binding);
+
+  // Leaves ponder mode without counting the time, so the search can be finished
+  void finishPondering();
 
   JobCommunicator comm_;
+  SplitPointPool pool_;
+  TimeManager timeManager_;
   TranspositionTable tt_;
   SoFBotApi::Server &server_;
 
   std::thread mainThread_;
+  std::vector<std::vector<size_t>> numaNodes_;  // Detected lazily on first use
+  bool isNumaDetected_ = false;
+  // Move ordering tables of each job, which persist between the searches in the same game
+  std::vector<std::unique_ptr<OrderingTables>> tables_;
+  bool clearTables_ = false;
+  // Time when `stop()` was called for the first time during the current search, in ticks of
+  // `std::chrono::steady_clock`. Zero if `stop()` was not called yet
+  std::atomic<std::chrono::steady_clock::rep> stopRequestTime_ = 0;
+  // Ponder mode state and the time point from which the time limits are counted
+  std::mutex ponderLock_;
+  std::condition_variable ponderEvent_;
+  bool isPondering_ = false;
+  std::chrono::steady_clock::time_point clockStartTime_;
   std::mutex hashChangeLock_;
   size_t hashSize_ = TranspositionTable::DEFAULT_SIZE;
   std::atomic<bool> debugMode_ = false;
@@ -1,5 +1,7 @@
 #include "search/private/limits.h"
 
+#include <algorithm>
+
 namespace SoFSearch::Private {
 
 using namespace std::chrono_literals;
@@ -7,7 +9,8 @@ using namespace std::chrono_literals;
 using std::chrono::milliseconds;
 
 SearchLimits SearchLimits::withTimeControl(const SoFCore::Board &board,
-                                           const SoFBotApi::TimeControl &timeControl) {
+                                           const SoFBotApi::TimeControl &timeControl,
+                                           const milliseconds moveOverhead) {
   milliseconds totalTime = timeControl[board.side].time;
   const milliseconds inc = timeControl[board.side].inc;
   if (totalTime == milliseconds::max()) {
@@ -15,19 +18,22 @@ SearchLimits SearchLimits::withTimeControl(const SoFCore::Board &board,
     // valid, but it's better to come up with some definite value other than infinity.
     totalTime = 1h;
   }
-  milliseconds time = totalTime;
-  if (board.moveNumber < 10) {
-    time /= 40;
-  } else {
-    time /= 20;
-  }
-  if (board.moveNumber > 30) {
-    time += totalTime / 40;
+  const milliseconds available = std::max(totalTime - moveOverhead, 1ms);
+
+  // Estimate the number of moves we need to make with the remaining time. If the server didn't tell
+  // us, assume that the games become shorter as they progress
+  int64_t movesLeft = std::max<int64_t>(40 - std::min<int64_t>(board.moveNumber, 50) / 2, 15);
+  if (timeControl.movesToGo != SoFBotApi::MOVES_INFINITE) {
+    // Some servers send zero moves to go, though it must be positive, so we clamp it
+    movesLeft = static_cast<int64_t>(std::clamp<size_t>(timeControl.movesToGo, 1, 50));
   }
-  time += inc;
-  time = std::min(time, totalTime - 35ms);
-  time = std::max(time, 1ms);
-  return SearchLimits{DEPTH_UNLIMITED, NODES_UNLIMITED, time, timeControl};
+
+  // Soft limit is the time we expect to spend on this move. Time manager may extend it if the
+  // position is unclear, but never beyond the hard limit
+  milliseconds softTime = available / movesLeft + inc * 3 / 4;
+  const milliseconds hardTime = std::max(std::min(available * 4 / 5, softTime * 5), 1ms);
+  softTime = std::clamp(softTime, 1ms, hardTime);
+  return SearchLimits{DEPTH_UNLIMITED, NODES_UNLIMITED, hardTime, softTime, timeControl, MATE_NONE};
 }
 
 }  // namespace SoFSearch::Private
@@ -13,6 +13,7 @@ namespace SoFSearch::Private {
 constexpr size_t DEPTH_UNLIMITED = std::numeric_limits<size_t>::max();
 constexpr uint64_t NODES_UNLIMITED = std::numeric_limits<uint64_t>::max();
 constexpr std::chrono::milliseconds TIME_UNLIMITED = std::chrono::milliseconds::max();
+constexpr size_t MATE_NONE = 0;
 
 struct SearchLimits {
   // Maximum depth (or `DEPTH_UNLIMITED` if unlimited)
@@ -21,31 +22,48 @@ struct SearchLimits {
   uint64_t nodes = NODES_UNLIMITED;
   // Maximum time (or `TIME_UNLIMITED` if unlimited)
   std::chrono::milliseconds time = TIME_UNLIMITED;
+  // Optimal time to think (or `TIME_UNLIMITED` if the search must run until other limits are hit).
+  // The search may stop earlier or later than this time, but it never runs longer than `time`
+  std::chrono::milliseconds softTime = TIME_UNLIMITED;
   // Time control (default-constructed if not present)
   SoFBotApi::TimeControl timeControl;
+  // Maximum number of moves to checkmate (or `MATE_NONE` if we don't search for checkmate). If
+  // this value is set, the search stops as soon as such checkmate is found
+  size_t mate = MATE_NONE;
 
   // Constructs `SearchLimits` with infinite time
   inline static SearchLimits withInfiniteTime() { return SearchLimits{}; }
 
   // Constructs `SearchLimits` for fixed depth
   inline static SearchLimits withFixedDepth(const size_t depth) {
-    return SearchLimits{depth, NODES_UNLIMITED, TIME_UNLIMITED, SoFBotApi::TimeControl{}};
+    return SearchLimits{depth, NODES_UNLIMITED, TIME_UNLIMITED, TIME_UNLIMITED,
+                        SoFBotApi::TimeControl{}, MATE_NONE};
   }
 
   // Constructs `SearchLimits` for fixed nodes
   inline static SearchLimits withFixedNodes(const uint64_t nodes) {
-    return SearchLimits{DEPTH_UNLIMITED, nodes, TIME_UNLIMITED, SoFBotApi::TimeControl{}};
+    return SearchLimits{DEPTH_UNLIMITED, nodes, TIME_UNLIMITED, TIME_UNLIMITED,
+                        SoFBotApi::TimeControl{}, MATE_NONE};
   }
 
   // Constructs `SearchLimits` for fixed time
   inline static SearchLimits withFixedTime(const std::chrono::milliseconds time) {
-    return SearchLimits{DEPTH_UNLIMITED, NODES_UNLIMITED, time, SoFBotApi::TimeControl{}};
+    return SearchLimits{DEPTH_UNLIMITED, NODES_UNLIMITED, time, TIME_UNLIMITED,
+                        SoFBotApi::TimeControl{}, MATE_NONE};
+  }
+
+  // Constructs `SearchLimits` to find checkmate in at most `moves` moves
+  inline static SearchLimits withMate(const size_t moves) {
+    return SearchLimits{DEPTH_UNLIMITED, NODES_UNLIMITED, TIME_UNLIMITED, TIME_UNLIMITED,
+                        SoFBotApi::TimeControl{}, moves};
   }
 
   // Constructs `SearchLimits` for given time control. This function also determines thinking time
-  // based on the given time control.
+  // based on the given time control. `moveOverhead` is the time which is lost on each move due to
+  // communication delays, so we never plan to use it for thinking.
   static SearchLimits withTimeControl(const SoFCore::Board &board,
-                                      const SoFBotApi::TimeControl &timeControl);
+                                      const SoFBotApi::TimeControl &timeControl,
+                                      std::chrono::milliseconds moveOverhead);
 };
 
 }  // namespace SoFSearch::Private
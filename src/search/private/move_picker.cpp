@@ -1,6 +1,7 @@
 #include "search/private/move_picker.h"
 
 #include <algorithm>
+#include <limits>
 
 #include "util/misc.h"
 
@@ -9,22 +10,49 @@ namespace SoFSearch::Private {
 using SoFCore::Board;
 using SoFCore::Move;
 
-void sortMvvLva(const Board &board, Move *moves, const size_t count) {
-  constexpr uint8_t victimOrd[16] = {8, 8, 0, 16, 24, 32, 40, 0, 8, 8, 0, 16, 24, 32, 40, 0};
-  constexpr uint8_t attackerOrd[16] = {0, 6, 1, 5, 4, 3, 2, 0, 0, 6, 1, 5, 4, 3, 2, 0};
-  for (size_t i = 0; i < count; ++i) {
-    Move &move = moves[i];
-    move.tag = victimOrd[board.cells[move.dst]] + attackerOrd[board.cells[move.src]];
-  }
-  std::sort(moves, moves + count, [&](const Move m1, const Move m2) { return m1.tag > m2.tag; });
+// Weights of the captured material and the capture history in the capture score. They are chosen
+// so that the capture history can reorder the captures of pieces with close values, but not a pawn
+// capture and a queen capture
+constexpr int CAPTURE_VICTIM_WEIGHT = 16;
+constexpr int CAPTURE_HISTORY_DIVISOR = 8;
+
+inline static int mvvLvaScore(const Board &board, const Move move) {
+  constexpr int victimOrd[16] = {8, 8, 0, 16, 24, 32, 40, 0, 8, 8, 0, 16, 24, 32, 40, 0};
+  constexpr int attackerOrd[16] = {0, 6, 1, 5, 4, 3, 2, 0, 0, 6, 1, 5, 4, 3, 2, 0};
+  return victimOrd[board.cells[move.dst]] + attackerOrd[board.cells[move.src]];
+}
+
+// Computes `quietMoveScore()` for `count` moves from `moves` and stores the results into `scores`
+static void scoreQuietMoves(const Board &board, const MoveHistory &history, const Move *moves,
+                            int *scores, const size_t count) {
   for (size_t i = 0; i < count; ++i) {
-    moves[i].tag = 0;
+    const Move move = moves[i];
+    scores[i] = quietMoveScore(history, move, PieceSquare{board.cells[move.src], move.dst});
   }
 }
 
-QuiescenseMovePicker::QuiescenseMovePicker(const Board &board) : movePosition_(0) {
+QuiescenseMovePicker::QuiescenseMovePicker(const Board &board, const Move hashMove,
+                                           const bool inCheck)
+    : movePosition_(0) {
   moveCount_ = genCaptures(board, moves_);
-  sortMvvLva(board, moves_, moveCount_);
+  for (size_t i = 0; i < moveCount_; ++i) {
+    scores_[i] = mvvLvaScore(board, moves_[i]);
+  }
+  if (inCheck) {
+    // Quiet evasions go after all the captures
+    const size_t captureCount = moveCount_;
+    moveCount_ += genSimpleMoves(board, moves_ + moveCount_);
+    std::fill(scores_ + captureCount, scores_ + moveCount_, -1);
+  }
+  // Try the move from hash first, if it's among the generated ones
+  if (hashMove != Move::null()) {
+    for (size_t i = 0; i < moveCount_; ++i) {
+      if (moves_[i] == hashMove) {
+        scores_[i] = std::numeric_limits<int>::max();
+        break;
+      }
+    }
+  }
 }
 
 void MovePicker::nextStage() {
@@ -47,35 +75,48 @@ void MovePicker::nextStage() {
         break;
       }
       case MovePickerStage::Capture: {
-        // Generate captures and sort them by MVV/LVA
+        // Score the captures by the captured material and capture history. The captures which lose
+        // material are postponed by `next()`
         moveCount_ = genCaptures(board_, moves_);
-        sortMvvLva(board_, moves_, moveCount_);
+        for (size_t i = 0; i < moveCount_; ++i) {
+          const Move move = moves_[i];
+          const PieceSquare key{board_.cells[move.src], move.dst};
+          scores_[i] = CAPTURE_VICTIM_WEIGHT * moveMaterialGain(board_, move) +
+                       history_.captures.get(key, board_.cells[move.dst]) / CAPTURE_HISTORY_DIVISOR;
+        }
         break;
       }
       case MovePickerStage::Killer: {
-        // Try two killers if they are valid
-        const Move firstKiller = killers_.first();
-        if (!isMoveCapture(board_, firstKiller) && isMoveValid(board_, firstKiller)) {
-          moves_[moveCount_++] = firstKiller;
-        }
-        const Move secondKiller = killers_.second();
-        if (!isMoveCapture(board_, secondKiller) && isMoveValid(board_, secondKiller)) {
-          moves_[moveCount_++] = secondKiller;
+        // Try two killers and counter move if they are valid
+        const Move candidates[3] = {killers_.first(), killers_.second(), history_.counterMove};
+        for (const Move move : candidates) {
+          if (move == Move::null() || isMoveCapture(board_, move) || !isMoveValid(board_, move)) {
+            continue;
+          }
+          if (std::find(moves_, moves_ + moveCount_, move) != moves_ + moveCount_) {
+            continue;
+          }
+          refutations_[moveCount_] = move;
+          moves_[moveCount_++] = move;
         }
-        savedKillers_[0] = firstKiller;
-        savedKillers_[1] = secondKiller;
         break;
       }
       case MovePickerStage::History: {
-        // Sort the moves by history heuristic
-        moveCount_ = genSimpleMoves(board_, moves_);
-        std::sort(moves_, moves_ + moveCount_,
-                  [&](const Move m1, const Move m2) { return history_[m1] > history_[m2]; });
-        for (size_t i = 0; i < moveCount_; ++i) {
-          if (moves_[i] == savedKillers_[0] || moves_[i] == savedKillers_[1]) {
-            moves_[i] = Move::null();
+        // Score the quiet moves by history heuristics, skipping the ones tried on killer stage
+        const size_t count = genSimpleMoves(board_, moves_);
+        for (size_t i = 0; i < count; ++i) {
+          const Move move = moves_[i];
+          if (move != refutations_[0] && move != refutations_[1] && move != refutations_[2]) {
+            moves_[moveCount_++] = move;
           }
         }
+        scoreQuietMoves(board_, history_, moves_, scores_, moveCount_);
+        break;
+      }
+      case MovePickerStage::BadCapture: {
+        // Try the captures which lose material in the order they were postponed
+        std::copy(badCaptures_, badCaptures_ + badCaptureCount_, moves_);
+        moveCount_ = badCaptureCount_;
         break;
       }
       case MovePickerStage::End: {
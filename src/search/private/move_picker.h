@@ -1,9 +1,13 @@
 #ifndef SOF_SEARCH_PRIVATE_MOVE_PICKER_INCLUDED
 #define SOF_SEARCH_PRIVATE_MOVE_PICKER_INCLUDED
 
+#include <cstddef>
+#include <utility>
+
 #include "core/board.h"
 #include "core/move.h"
 #include "core/movegen.h"
+#include "search/private/see.h"
 #include "search/private/util.h"
 #include "util/operators.h"
 
@@ -14,16 +18,52 @@ namespace SoFSearch::Private {
 enum class MovePickerStage {
   Start = 0,
   HashMove = 1,
-  Capture = 2,
-  Killer = 3,
+  Capture = 2,  // Captures and promotions which don't lose material by static exchange evaluation
+  Killer = 3,  // Killers and counter move
   History = 4,
-  End = 5
+  BadCapture = 5,  // Captures and promotions which lose material by static exchange evaluation
+  End = 6
 };
 
 SOF_ENUM_COMPARE(MovePickerStage, int)
 
+// Returns `true` if the moves from stage `stage` are quiet (i.e. not captures or promotions)
+inline constexpr bool isQuietStage(const MovePickerStage stage) {
+  return stage == MovePickerStage::Killer || stage == MovePickerStage::History;
+}
+
+// Returns `true` if the moves from stage `stage` are captures or promotions
+inline constexpr bool isCaptureStage(const MovePickerStage stage) {
+  return stage == MovePickerStage::Capture || stage == MovePickerStage::BadCapture;
+}
+
+// Heuristics which are used to order the moves
+struct MoveHistory {
+  const HistoryTable &history;
+  const CaptureHistory &captures;
+  const ContinuationHistory::Slice *continuations[CONTINUATION_PLIES];  // `nullptr` if no move
+  SoFCore::Move counterMove;  // Null move if there is no counter move
+};
+
+// Returns the history score of the quiet move `move`. `key` is the moved piece and the destination
+// cell of this move
+inline int quietMoveScore(const MoveHistory &history, const SoFCore::Move move,
+                          const PieceSquare key) {
+  int score = history.history[move];
+  for (const ContinuationHistory::Slice *slice : history.continuations) {
+    if (slice) {
+      score += (*slice)[key];
+    }
+  }
+  return score;
+}
+
 // Iterates over all the pseudo-legal moves in a given position. The moves arrive in an order which
 // is good for alpha-beta search.
+//
+// The moves within the stages are not sorted in advance. Instead, the best remaining move is
+// selected on each call of `next()`, as the beta cutoff often occurs after the first few moves, and
+// sorting the remaining ones is just a waste of time.
 class MovePicker {
 public:
   // Returns the type of the last move returned by the last call of `next()`. See `MovePickerStage`
@@ -37,37 +77,66 @@ public:
     if (movePosition_ == moveCount_) {
       nextStage();
     }
+    if (stage_ == MovePickerStage::Capture || stage_ == MovePickerStage::History) {
+      selectBest();
+    }
     const Move move = moves_[movePosition_++];
-    return (stage_ != MovePickerStage::HashMove && move == hashMove_) ? Move::null() : move;
+    if (stage_ != MovePickerStage::HashMove && move == hashMove_) {
+      return Move::null();
+    }
+    if (stage_ == MovePickerStage::Capture && !isSeeAtLeast(board_, move, 0)) {
+      // Postpone the losing capture until all the quiet moves are tried
+      badCaptures_[badCaptureCount_++] = move;
+      return Move::null();
+    }
+    return move;
   }
 
   MovePicker(const SoFCore::Board &board, const SoFCore::Move hashMove, const KillerLine &killers,
-             const HistoryTable &history)
+             const MoveHistory &history)
       : stage_(MovePickerStage::Start),
         hashMove_(hashMove),
         board_(board),
         killers_(killers),
         history_(history),
-        savedKillers_{SoFCore::Move::null(), SoFCore::Move::null()},
+        refutations_{SoFCore::Move::null(), SoFCore::Move::null(), SoFCore::Move::null()},
         moveCount_(0),
-        movePosition_(0) {}
+        movePosition_(0),
+        badCaptureCount_(0) {}
 
 private:
   void nextStage();
 
+  // Moves the move with the largest score among the remaining ones to the current position
+  inline void selectBest() {
+    size_t best = movePosition_;
+    for (size_t i = movePosition_ + 1; i < moveCount_; ++i) {
+      if (scores_[i] > scores_[best]) {
+        best = i;
+      }
+    }
+    std::swap(moves_[movePosition_], moves_[best]);
+    std::swap(scores_[movePosition_], scores_[best]);
+  }
+
   MovePickerStage stage_;
   SoFCore::Move hashMove_;
   const SoFCore::Board &board_;
   const KillerLine &killers_;
-  const HistoryTable &history_;
+  MoveHistory history_;
+  SoFCore::Move refutations_[3];
   SoFCore::Move moves_[SoFCore::BUFSZ_MOVES];
-  SoFCore::Move savedKillers_[2];
+  int scores_[SoFCore::BUFSZ_MOVES];
+  SoFCore::Move badCaptures_[SoFCore::BUFSZ_CAPTURES];
   size_t moveCount_;
   size_t movePosition_;
+  size_t badCaptureCount_;
 };
 
 // Iterates over all the moves that must be considered in quiescense search. The moves arrive in a
-// "good" order, i.e. the order to make the quiescense search work faster.
+// "good" order, i.e. the order to make the quiescense search work faster. If the side to move is
+// in check, all the moves are returned, as all the evasions must be considered. Otherwise, only
+// captures and promotions are returned.
 class QuiescenseMovePicker {
 public:
   // Returns the next move. If the move is equal to `Move::invalid()`, then there are no moves left.
@@ -76,13 +145,22 @@ public:
     if (movePosition_ == moveCount_) {
       return SoFCore::Move::invalid();
     }
+    size_t best = movePosition_;
+    for (size_t i = movePosition_ + 1; i < moveCount_; ++i) {
+      if (scores_[i] > scores_[best]) {
+        best = i;
+      }
+    }
+    std::swap(moves_[movePosition_], moves_[best]);
+    std::swap(scores_[movePosition_], scores_[best]);
     return moves_[movePosition_++];
   }
 
-  explicit QuiescenseMovePicker(const SoFCore::Board &board);
+  QuiescenseMovePicker(const SoFCore::Board &board, SoFCore::Move hashMove, bool inCheck);
 
 private:
-  SoFCore::Move moves_[SoFCore::BUFSZ_CAPTURES];
+  SoFCore::Move moves_[SoFCore::BUFSZ_MOVES];
+  int scores_[SoFCore::BUFSZ_MOVES];
   size_t moveCount_;
   size_t movePosition_;
 };
@@ -0,0 +1,107 @@
+#include "search/private/see.h"
+
+#include "core/movegen.h"
+#include "core/types.h"
+#include "util/bit.h"
+
+namespace SoFSearch::Private {
+
+using SoFCore::bitboard_t;
+using SoFCore::Color;
+using SoFCore::coord_t;
+using SoFCore::Move;
+using SoFCore::MoveKind;
+using SoFCore::Piece;
+
+// Piece values used in static exchange evaluation, indexed by `Piece`. King has the value which is
+// larger than any possible gain, so it's never exchanged
+constexpr int SEE_PIECE_VALUES[6] = {100, 20000, 350, 350, 525, 1000};
+
+// The order in which the pieces are used to capture on the exchange cell
+constexpr Piece SEE_ATTACKER_ORDER[6] = {Piece::Pawn, Piece::Knight, Piece::Bishop,
+                                         Piece::Rook, Piece::Queen,  Piece::King};
+
+inline static int pieceValue(const Piece piece) {
+  return SEE_PIECE_VALUES[static_cast<size_t>(piece)];
+}
+
+bool isSeeAtLeast(const SoFCore::Board &b, const Move move, const score_t threshold) {
+  if (move.kind == MoveKind::CastlingKingside || move.kind == MoveKind::CastlingQueenside) {
+    return threshold <= 0;
+  }
+
+  const coord_t dst = move.dst;
+  bitboard_t occupied = b.bbAll ^ SoFCore::coordToBitboard(move.src);
+  int victimValue = 0;
+  if (move.kind == MoveKind::Enpassant) {
+    victimValue = pieceValue(Piece::Pawn);
+    occupied ^= SoFCore::coordToBitboard(SoFCore::enpassantPawnPos(b.side, dst));
+  } else if (b.cells[dst] != SoFCore::EMPTY_CELL) {
+    victimValue = pieceValue(SoFCore::cellPiece(b.cells[dst]));
+  }
+  int attackerValue = pieceValue(SoFCore::cellPiece(b.cells[move.src]));
+  if (isMoveKindPromote(move.kind)) {
+    const int promoteValue = pieceValue(moveKindPromotePiece(move.kind));
+    victimValue += promoteValue - pieceValue(Piece::Pawn);
+    attackerValue = promoteValue;
+  }
+
+  // `swap` holds the value which must be recovered by the side which captured last, so that the
+  // exchange result satisfies the threshold. At each step, the side to move recaptures with its
+  // least valuable attacker, and `result` indicates whether the exchange is good for the side which
+  // made the initial move if it stops here
+  int swap = victimValue - threshold;
+  if (swap < 0) {
+    return false;
+  }
+  swap = attackerValue - swap;
+  if (swap <= 0) {
+    return true;
+  }
+
+  Color side = b.side;
+  bool result = true;
+  for (;;) {
+    side = invert(side);
+    const bitboard_t attackers = cellAttackers(b, dst, occupied);
+    const bitboard_t ourAttackers = attackers & b.bbColor(side);
+    if (!ourAttackers) {
+      break;
+    }
+    result = !result;
+    Piece piece = Piece::King;
+    bitboard_t bbPiece = 0;
+    for (const Piece candidate : SEE_ATTACKER_ORDER) {
+      bbPiece = ourAttackers & b.bbPieces[makeCell(side, candidate)];
+      if (bbPiece) {
+        piece = candidate;
+        break;
+      }
+    }
+    if (piece == Piece::King) {
+      // King can recapture only if the opponent has no more attackers
+      return (attackers & ~b.bbColor(side)) ? !result : result;
+    }
+    swap = pieceValue(piece) - swap;
+    if (swap < static_cast<int>(result)) {
+      break;
+    }
+    occupied ^= SoFCore::coordToBitboard(SoFUtil::getLowest(bbPiece));
+  }
+  return result;
+}
+
+score_t moveMaterialGain(const SoFCore::Board &b, const Move move) {
+  int gain = 0;
+  if (move.kind == MoveKind::Enpassant) {
+    gain = pieceValue(Piece::Pawn);
+  } else if (b.cells[move.dst] != SoFCore::EMPTY_CELL) {
+    gain = pieceValue(SoFCore::cellPiece(b.cells[move.dst]));
+  }
+  if (isMoveKindPromote(move.kind)) {
+    gain += pieceValue(moveKindPromotePiece(move.kind)) - pieceValue(Piece::Pawn);
+  }
+  return static_cast<score_t>(gain);
+}
+
+}  // namespace SoFSearch::Private
@@ -0,0 +1,22 @@
+#ifndef SOF_SEARCH_PRIVATE_SEE_INCLUDED
+#define SOF_SEARCH_PRIVATE_SEE_INCLUDED
+
+#include "core/board.h"
+#include "core/move.h"
+#include "search/private/score.h"
+
+namespace SoFSearch::Private {
+
+// Returns `true` if static exchange evaluation of move `move` is at least `threshold`, i.e. the
+// side which makes the move gains at least `threshold` in material after all the exchanges on the
+// destination cell, given that both sides may stop the exchanges at any moment. The move must be
+// pseudo-legal. Castling moves are considered to have zero exchange value.
+bool isSeeAtLeast(const SoFCore::Board &b, SoFCore::Move move, score_t threshold);
+
+// Returns the material gained by move `move` if it's not recaptured, i.e. the value of the captured
+// piece plus the promotion gain. Uses the same piece values as `isSeeAtLeast()`
+score_t moveMaterialGain(const SoFCore::Board &b, SoFCore::Move move);
+
+}  // namespace SoFSearch::Private
+
+#endif  // SOF_SEARCH_PRIVATE_SEE_INCLUDED
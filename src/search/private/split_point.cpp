@@ -0,0 +1,131 @@
+#include "search/private/split_point.h"
+
+#include <algorithm>
+
+namespace SoFSearch::Private {
+
+using SoFCore::Move;
+
+bool SplitPoint::next(Move &move, MovePickerStage &stage, size_t &index, score_t &alpha) {
+  std::unique_lock lock(lock_);
+  if (movePosition_ == moveCount_ || cutoff_.load(std::memory_order_relaxed)) {
+    return false;
+  }
+  move = moves_[movePosition_];
+  stage = stages_[movePosition_];
+  index = movePosition_++;
+  alpha = alpha_;
+  return true;
+}
+
+bool SplitPoint::update(const size_t index, const Move move, const score_t score,
+                        const uint64_t nodes) {
+  std::unique_lock lock(lock_);
+  moveNodes_[index] = nodes;
+  if (cutoff_.load(std::memory_order_relaxed) || score <= alpha_) {
+    return false;
+  }
+  moveScores_[index] = score;
+  alpha_ = score;
+  bestMove_ = move;
+  if (alpha_ >= beta_) {
+    cutoff_.store(true, std::memory_order_relaxed);
+    return true;
+  }
+  return false;
+}
+
+bool SplitPoint::hasWork() {
+  std::unique_lock lock(lock_);
+  return movePosition_ != moveCount_ && !cutoff_.load(std::memory_order_relaxed);
+}
+
+void SplitPointPool::publish(SplitPoint &sp) {
+  {
+    std::unique_lock lock(lock_);
+    points_.push_back(&sp);
+  }
+  event_.notify_all();
+}
+
+void SplitPointPool::retract(SplitPoint &sp) {
+  std::unique_lock lock(lock_);
+  points_.erase(std::find(points_.begin(), points_.end(), &sp));
+}
+
+SplitPoint *SplitPointPool::join() {
+  std::unique_lock lock(lock_);
+  idle_.fetch_add(1, std::memory_order_relaxed);
+  for (;;) {
+    if (shutdown_) {
+      idle_.fetch_sub(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    // Prefer the split points which were published earlier, as they are usually closer to the root
+    // and contain larger subtrees to search
+    for (SplitPoint *sp : points_) {
+      if (sp->hasWork()) {
+        {
+          std::unique_lock spLock(sp->lock_);
+          ++sp->helpers_;
+        }
+        idle_.fetch_sub(1, std::memory_order_relaxed);
+        return sp;
+      }
+    }
+    event_.wait(lock);
+  }
+}
+
+SplitPoint *SplitPointPool::joinBelow(SplitPoint &sp) {
+  std::unique_lock lock(lock_);
+  idle_.fetch_add(1, std::memory_order_relaxed);
+  for (;;) {
+    {
+      std::unique_lock spLock(sp.lock_);
+      if (sp.helpers_ == 0) {
+        idle_.fetch_sub(1, std::memory_order_relaxed);
+        return nullptr;
+      }
+    }
+    // The split points below `sp` are safe to join, as their masters are the helpers of `sp`, so
+    // they cannot finish until `sp` does
+    if (!shutdown_) {
+      for (SplitPoint *child : points_) {
+        if (child->isBelow(sp) && child->hasWork()) {
+          {
+            std::unique_lock childLock(child->lock_);
+            ++child->helpers_;
+          }
+          idle_.fetch_sub(1, std::memory_order_relaxed);
+          return child;
+        }
+      }
+    }
+    event_.wait(lock);
+  }
+}
+
+void SplitPointPool::leave(SplitPoint &sp) {
+  std::unique_lock lock(lock_);
+  std::unique_lock spLock(sp.lock_);
+  if (--sp.helpers_ == 0) {
+    // Notify while holding the locks, as master may destroy the split point right after it wakes up
+    event_.notify_all();
+  }
+}
+
+void SplitPointPool::shutdown() {
+  {
+    std::unique_lock lock(lock_);
+    shutdown_ = true;
+  }
+  event_.notify_all();
+}
+
+void SplitPointPool::reset() {
+  points_.clear();
+  shutdown_ = false;
+}
+
+}  // namespace SoFSearch::Private
@@ -0,0 +1,183 @@
+#ifndef SOF_SEARCH_PRIVATE_SPLIT_POINT_INCLUDED
+#define SOF_SEARCH_PRIVATE_SPLIT_POINT_INCLUDED
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "core/board.h"
+#include "core/move.h"
+#include "core/movegen.h"
+#include "search/private/evaluate.h"
+#include "search/private/move_picker.h"
+#include "search/private/score.h"
+#include "search/private/types.h"
+#include "search/private/util.h"
+#include "util/no_copy_move.h"
+
+namespace SoFSearch::Private {
+
+// Split point for young brothers wait parallel search. The split point is created by the job which
+// searches the node (called master) after the first move in this node is searched and no beta
+// cutoff occured. The remaining moves are then searched both by master and by idle jobs (called
+// helpers) which join the split point.
+//
+// The split point lives on master's stack, so master must not leave the node until all the helpers
+// leave the split point. While waiting for them, master helps to search the split points created by
+// the helpers below its own one.
+class SplitPoint : public SoFUtil::NoCopyMove {
+public:
+  inline SplitPoint(const SoFCore::Board &board, const HashHistory &hashes,
+                    const PrevMoves &prevMoves, SplitPoint *parent, const NodeKind kind,
+                    const size_t rootDepth, const size_t depth, const size_t idepth,
+                    const score_t alpha, const score_t beta, const PsqScore psq)
+      : board_(board),
+        hashes_(hashes),
+        prevMoves_(prevMoves),
+        parent_(parent),
+        kind_(kind),
+        rootDepth_(rootDepth),
+        depth_(depth),
+        idepth_(idepth),
+        beta_(beta),
+        psq_(psq),
+        alpha_(alpha) {}
+
+  // Adds the move to be searched in this split point. This function must be called only by master
+  // and only before the split point is published
+  inline void addMove(const SoFCore::Move move, const MovePickerStage stage) {
+    moves_[moveCount_] = move;
+    stages_[moveCount_] = stage;
+    moveScores_[moveCount_] = -SCORE_INF;
+    moveNodes_[moveCount_] = 0;
+    ++moveCount_;
+  }
+
+  // Fetches the next move to search, its stage and its index among the moves of the split point.
+  // Also puts the current value of alpha into `alpha`. Returns `false` if there are no moves left
+  // or the beta cutoff already occured
+  bool next(SoFCore::Move &move, MovePickerStage &stage, size_t &index, score_t &alpha);
+
+  // Reports that the move `move` with index `index` has score `score`, and its search visited
+  // `nodes` nodes. Returns `true` if the move caused beta cutoff
+  bool update(size_t index, SoFCore::Move move, score_t score, uint64_t nodes);
+
+  // Returns `true` if there was a beta cutoff in this split point or any of its parents. If this
+  // function returns `true`, then the search in this split point must be stopped
+  inline bool isCutoff() const {
+    for (const SplitPoint *sp = this; sp; sp = sp->parent_) {
+      if (sp->cutoff_.load(std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Returns `true` if the helpers may join the split point and get some work to do
+  bool hasWork();
+
+  // Returns `true` if the split point is a descendant of `sp`
+  inline bool isBelow(const SplitPoint &sp) const {
+    for (const SplitPoint *cur = parent_; cur; cur = cur->parent_) {
+      if (cur == &sp) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Returns the search results. Must be called only by master after all the helpers left
+  inline score_t alpha() const { return alpha_; }
+  inline SoFCore::Move bestMove() const { return bestMove_; }
+
+  // Returns the results of the moves in this split point. The score is `-SCORE_INF` if the move
+  // didn't improve alpha, and the number of nodes is zero if the move wasn't searched. Must be
+  // called only by master after all the helpers left
+  inline size_t moveCount() const { return moveCount_; }
+  inline SoFCore::Move move(const size_t index) const { return moves_[index]; }
+  inline score_t moveScore(const size_t index) const { return moveScores_[index]; }
+  inline uint64_t moveNodes(const size_t index) const { return moveNodes_[index]; }
+
+  inline const SoFCore::Board &board() const { return board_; }
+  inline const HashHistory &hashes() const { return hashes_; }
+  inline const PrevMoves &prevMoves() const { return prevMoves_; }
+  inline SplitPoint *parent() const { return parent_; }
+  inline NodeKind kind() const { return kind_; }
+  inline size_t rootDepth() const { return rootDepth_; }
+  inline size_t depth() const { return depth_; }
+  inline size_t idepth() const { return idepth_; }
+  inline score_t beta() const { return beta_; }
+  inline PsqScore psq() const { return psq_; }
+
+private:
+  friend class SplitPointPool;
+
+  const SoFCore::Board board_;
+  const HashHistory hashes_;
+  const PrevMoves prevMoves_;
+  SplitPoint *const parent_;
+  const NodeKind kind_;
+  const size_t rootDepth_;
+  const size_t depth_;
+  const size_t idepth_;
+  const score_t beta_;
+  const PsqScore psq_;
+
+  std::mutex lock_;
+  SoFCore::Move moves_[SoFCore::BUFSZ_MOVES];
+  MovePickerStage stages_[SoFCore::BUFSZ_MOVES];
+  score_t moveScores_[SoFCore::BUFSZ_MOVES];
+  uint64_t moveNodes_[SoFCore::BUFSZ_MOVES];
+  size_t moveCount_ = 0;
+  size_t movePosition_ = 0;
+  size_t helpers_ = 0;
+  score_t alpha_;
+  SoFCore::Move bestMove_ = SoFCore::Move::null();
+  std::atomic<bool> cutoff_ = false;
+};
+
+// Registry of split points which are available for helpers to join
+class SplitPointPool : public SoFUtil::NoCopyMove {
+public:
+  // Returns `true` if there are helpers which wait for work
+  inline bool hasIdleHelpers() const { return idle_.load(std::memory_order_relaxed) != 0; }
+
+  // Makes the split point `sp` available for helpers
+  void publish(SplitPoint &sp);
+
+  // Makes the split point `sp` unavailable for helpers. The helpers which already joined it are
+  // not affected
+  void retract(SplitPoint &sp);
+
+  // Waits until some split point has work and joins it. Returns `nullptr` if the pool is shut down
+  SplitPoint *join();
+
+  // Waits until either all the helpers leave the split point `sp` or some split point below `sp`
+  // has work. In the latter case, joins this split point and returns it, otherwise returns
+  // `nullptr`. This allows master of `sp` to help its helpers instead of waiting idle
+  SplitPoint *joinBelow(SplitPoint &sp);
+
+  // Leaves the split point `sp` previously returned by `join()`
+  void leave(SplitPoint &sp);
+
+  // Wakes up all the waiting helpers and makes `join()` return `nullptr`
+  void shutdown();
+
+  // Resets the pool into its default state. This function must not be called when jobs are
+  // running
+  void reset();
+
+private:
+  std::mutex lock_;
+  std::condition_variable event_;
+  std::vector<SplitPoint *> points_;
+  std::atomic<size_t> idle_ = 0;
+  bool shutdown_ = false;
+};
+
+}  // namespace SoFSearch::Private
+
+#endif  // SOF_SEARCH_PRIVATE_SPLIT_POINT_INCLUDED
@@ -0,0 +1,109 @@
+#include "search/private/time_manager.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace SoFSearch::Private {
+
+using SoFCore::Move;
+using std::chrono::steady_clock;
+
+// Multipliers for the soft limit, indexed by the number of iterations the best move didn't change
+constexpr double STABILITY_SCALE[] = {1.6, 1.3, 1.1, 1.0, 0.85, 0.7};
+constexpr size_t STABILITY_SCALE_SZ = std::size(STABILITY_SCALE);
+
+// Score drop (in centipawns) after which we don't extend the soft limit any further
+constexpr int SCORE_DROP_MAX = 150;
+
+// Maximum multiplier for the soft limit caused by the score drop
+constexpr double SCORE_DROP_SCALE = 1.5;
+
+// Multipliers for the soft limit when the best move takes none of the nodes and all of them. The
+// larger share of the tree the best move takes, the less likely another move is going to replace it
+constexpr double NODE_FRACTION_SCALE_ZERO = 1.25;
+constexpr double NODE_FRACTION_SCALE_ONE = 0.75;
+
+// Bounds for the effective branching factor, which is used to predict the duration of the next
+// iteration. Short iterations give noisy measurements, so we use the default value for them
+constexpr double BRANCHING_DEFAULT = 2.0;
+constexpr double BRANCHING_MIN = 1.2;
+constexpr double BRANCHING_MAX = 6.0;
+constexpr auto BRANCHING_MIN_ITERATION_TIME = std::chrono::milliseconds(2);
+
+void TimeManager::start(const SearchLimits &limits, const steady_clock::time_point startTime,
+                        const bool isPondering) {
+  std::unique_lock lock(lock_);
+  enabled_ = (limits.softTime != TIME_UNLIMITED);
+  isPondering_ = isPondering;
+  startTime_ = startTime;
+  if (enabled_) {
+    // Do not convert `TIME_UNLIMITED` to `Duration`, as it would overflow
+    softTime_ = limits.softTime;
+    hardTime_ = (limits.time == TIME_UNLIMITED) ? Duration::max()
+                                                : std::max<Duration>(limits.time, softTime_);
+  }
+  lastFinish_ = Duration::zero();
+  lastIterationTime_ = Duration::zero();
+  bestMove_ = Move::null();
+  stableIterations_ = 0;
+  score_ = 0;
+}
+
+void TimeManager::ponderHit(const steady_clock::time_point time) {
+  std::unique_lock lock(lock_);
+  isPondering_ = false;
+  // Shift the time of the last finished iteration, so it's measured from the new start time. It
+  // becomes negative, but the durations of the next iterations are still computed correctly
+  lastFinish_ -= time - startTime_;
+  startTime_ = time;
+}
+
+bool TimeManager::finishIteration(const size_t depth, const Move bestMove, const score_t score,
+                                  const double bestMoveNodeFraction) {
+  std::unique_lock lock(lock_);
+  if (!enabled_) {
+    return false;
+  }
+  const Duration elapsed = steady_clock::now() - startTime_;
+  const Duration iterationTime = elapsed - lastFinish_;
+
+  double branching = BRANCHING_DEFAULT;
+  if (lastIterationTime_ >= BRANCHING_MIN_ITERATION_TIME) {
+    branching = std::clamp(static_cast<double>(iterationTime.count()) /
+                               static_cast<double>(lastIterationTime_.count()),
+                           BRANCHING_MIN, BRANCHING_MAX);
+  }
+
+  stableIterations_ = (depth > 1 && bestMove == bestMove_) ? stableIterations_ + 1 : 0;
+  const int scoreDrop =
+      (depth > 1 && !isScoreCheckmate(score) && !isScoreCheckmate(score_)) ? score_ - score : 0;
+
+  lastFinish_ = elapsed;
+  lastIterationTime_ = iterationTime;
+  bestMove_ = bestMove;
+  score_ = score;
+
+  double scale = STABILITY_SCALE[std::min(stableIterations_, STABILITY_SCALE_SZ - 1)];
+  if (scoreDrop > 0) {
+    scale *= 1.0 + (SCORE_DROP_SCALE - 1.0) * std::min(scoreDrop, SCORE_DROP_MAX) / SCORE_DROP_MAX;
+  }
+  if (depth > 1) {
+    scale *= NODE_FRACTION_SCALE_ZERO +
+             (NODE_FRACTION_SCALE_ONE - NODE_FRACTION_SCALE_ZERO) * bestMoveNodeFraction;
+  }
+  if (isPondering_) {
+    return false;
+  }
+  const auto allocated =
+      std::min(std::chrono::duration_cast<Duration>(softTime_ * scale), hardTime_);
+  if (elapsed >= allocated) {
+    return true;
+  }
+
+  // Don't start the next iteration if it's not going to finish before the hard limit, as the
+  // results of the unfinished iteration are thrown away
+  const auto predicted = std::chrono::duration_cast<Duration>(iterationTime * branching);
+  return elapsed + predicted > hardTime_;
+}
+
+}  // namespace SoFSearch::Private
@@ -0,0 +1,59 @@
+#ifndef SOF_SEARCH_PRIVATE_TIME_MANAGER_INCLUDED
+#define SOF_SEARCH_PRIVATE_TIME_MANAGER_INCLUDED
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+
+#include "core/move.h"
+#include "search/private/limits.h"
+#include "search/private/score.h"
+
+namespace SoFSearch::Private {
+
+// Decides when to stop the search under time control. The hard limit (i.e. `SearchLimits::time`) is
+// enforced by the job runner, while this class decides whether to continue iterative deepening
+// after each iteration. The soft limit is scaled depending on how stable the search results are:
+// we think longer when the best move changes or the score drops, and stop early if the best move
+// remains the same for several iterations or takes most of the nodes in the search tree.
+//
+// While pondering, the search is never stopped, but the statistics of the iterations are still
+// collected, so they can be used after ponderhit.
+//
+// This class is thread-safe.
+class TimeManager {
+public:
+  // Prepares the time manager for the new search. If `isPondering` is `true`, the time is not
+  // counted until `ponderHit()` is called
+  void start(const SearchLimits &limits, std::chrono::steady_clock::time_point startTime,
+             bool isPondering);
+
+  // Leaves ponder mode. The time is counted from `time` after this call
+  void ponderHit(std::chrono::steady_clock::time_point time);
+
+  // Reports that the iteration on depth `depth` has finished with the given best move and score.
+  // `bestMoveNodeFraction` is the share of nodes spent on the best move in this iteration. Returns
+  // `true` if the search must be stopped now
+  bool finishIteration(size_t depth, SoFCore::Move bestMove, score_t score,
+                       double bestMoveNodeFraction);
+
+private:
+  using Duration = std::chrono::steady_clock::duration;
+
+  std::mutex lock_;
+  bool enabled_ = false;
+  bool isPondering_ = false;
+  std::chrono::steady_clock::time_point startTime_;
+  Duration softTime_ = Duration::zero();
+  Duration hardTime_ = Duration::zero();
+
+  Duration lastFinish_ = Duration::zero();
+  Duration lastIterationTime_ = Duration::zero();
+  SoFCore::Move bestMove_ = SoFCore::Move::null();
+  size_t stableIterations_ = 0;
+  score_t score_ = 0;
+};
+
+}  // namespace SoFSearch::Private
+
+#endif  // SOF_SEARCH_PRIVATE_TIME_MANAGER_INCLUDED
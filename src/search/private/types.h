@@ -5,21 +5,42 @@
 
 #include "core/board.h"
 #include "core/move.h"
+#include "search/private/util.h"
 
 namespace SoFSearch::Private {
 
+// Kind of the node in the search tree
+enum class NodeKind { Root, Pv, Simple };
+
+// The way to handle the nodes in which there is no hash move, so the move ordering is poor
+enum class InternalIterativeMode {
+  // Search such nodes as usual
+  None,
+  // Perform a reduced depth search first to find the best move, and use it as a hash move
+  // (internal iterative deepening)
+  Deepening,
+  // Reduce the depth of such nodes, assuming that they are not important, as they were not
+  // searched before (internal iterative reductions)
+  Reductions
+};
+
 // Position with saved previous moves
 struct Position {
   SoFCore::Board first;
   std::vector<SoFCore::Move> moves;
   SoFCore::Board last;
+  // Hashes of the positions before `last`, with `last` marked as the search root
+  HashHistory hashes;
 
-  // Constructs `Position` from `first` and `moves`, calculating `last`
+  // Constructs `Position` from `first` and `moves`, calculating `last` and `hashes`. This is done
+  // once per position, so the search threads only need to copy the result
   inline static Position from(const SoFCore::Board &first, std::vector<SoFCore::Move> moves) {
-    Position position{first, std::move(moves), first};
+    Position position{first, std::move(moves), first, HashHistory()};
     for (SoFCore::Move move : position.moves) {
+      position.hashes.push(position.last, false);
       moveMake(position.last, move);
     }
+    position.hashes.markRoot();
     return position;
   }
 };
@@ -2,9 +2,15 @@
 #define SOF_SEARCH_PRIVATE_UTIL_INCLUDED
 
 #include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
 #include <memory>
+#include <vector>
 
+#include "core/board.h"
 #include "core/move.h"
+#include "core/movegen.h"
 #include "core/types.h"
 #include "util/misc.h"
 
@@ -33,85 +39,258 @@ private:
   SoFCore::Move second_ = SoFCore::Move::null();
 };
 
-// History table used for history heuristics
+// Bound for the absolute values in the history tables
+constexpr int HISTORY_MAX = 16384;
+
+// Divisor which is applied to all the history values before each new search in the same game, so
+// the statistics from the previous searches have less weight than the new ones
+constexpr int HISTORY_AGING_DIVISOR = 2;
+
+// Applies aging to the history values in `table` of size `size`
+template <typename T>
+inline void ageHistory(T *table, const size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    table[i] /= HISTORY_AGING_DIVISOR;
+  }
+}
+
+// Updates the history value `value` with `bonus`, which is positive if the move was good and
+// negative otherwise. The larger the value is, the smaller effect the positive bonus has (and vice
+// versa), so the value always stays within `[-HISTORY_MAX, HISTORY_MAX]`, and the old statistics
+// gradually decay as the new updates arrive
+template <typename T>
+inline constexpr void updateHistory(T &value, int bonus) {
+  bonus = std::clamp(bonus, -HISTORY_MAX, HISTORY_MAX);
+  const int old = value;
+  value = static_cast<T>(old + bonus - old * std::abs(bonus) / HISTORY_MAX);
+}
+
+// History table used for history heuristics. It's indexed by source and destination cells of the
+// move
 class HistoryTable {
 public:
-  HistoryTable() : tab_(std::make_unique<uint64_t[]>(TAB_SIZE)) {
+  HistoryTable() : tab_(std::make_unique<int32_t[]>(TAB_SIZE)) {
     std::fill(tab_.get(), tab_.get() + TAB_SIZE, 0);
   }
 
-  inline uint64_t &operator[](const SoFCore::Move move) { return tab_[indexOf(move)]; }
-  inline uint64_t operator[](const SoFCore::Move move) const { return tab_[indexOf(move)]; }
+  inline int operator[](const SoFCore::Move move) const { return tab_[indexOf(move)]; }
+
+  inline void update(const SoFCore::Move move, const int bonus) {
+    updateHistory(tab_[indexOf(move)], bonus);
+  }
+
+  inline void age() { ageHistory(tab_.get(), TAB_SIZE); }
 
 private:
   inline constexpr static size_t indexOf(const SoFCore::Move move) {
     return (static_cast<size_t>(move.src) << 6) | static_cast<size_t>(move.dst);
   }
 
-  std::unique_ptr<uint64_t[]> tab_;
+  std::unique_ptr<int32_t[]> tab_;
 
   static constexpr size_t TAB_SIZE = 64 * 64;
 };
 
-// Small hash table to track draw by repetitions
-class RepetitionTable {
+// Moved piece and destination cell of the move. It's used as a key in the tables which depend on
+// the previous moves. Empty cell means that there is no such move (e.g. it's null move)
+struct PieceSquare {
+  SoFCore::cell_t cell = SoFCore::EMPTY_CELL;
+  SoFCore::coord_t dst = 0;
+
+  inline constexpr bool isValid() const { return cell != SoFCore::EMPTY_CELL; }
+
+  inline constexpr size_t index() const {
+    return (static_cast<size_t>(cell) << 6) | static_cast<size_t>(dst);
+  }
+
+  static constexpr size_t INDEX_COUNT = 16 * 64;
+};
+
+// Number of previous moves which are considered by continuation history
+constexpr size_t CONTINUATION_PLIES = 2;
+
+// Keys of the previous moves for continuation history. The first element corresponds to the last
+// move, the second one corresponds to the move before it, and so on
+using PrevMoves = std::array<PieceSquare, CONTINUATION_PLIES>;
+
+// Continuation history, i.e. the history of quiet moves indexed both by the move itself and by one
+// of the previous moves. The moves are identified by moved piece and destination cell
+class ContinuationHistory {
 public:
-  inline RepetitionTable()
-      : tab_(std::make_unique<SoFCore::board_hash_t[]>(INITIAL_BUCKET_COUNT * BUCKET_SIZE)),
-        bucketCount_(INITIAL_BUCKET_COUNT),
-        mask_((INITIAL_BUCKET_COUNT - 1) * BUCKET_SIZE) {
-    std::fill(tab_.get(), tab_.get() + INITIAL_BUCKET_COUNT * BUCKET_SIZE, 0);
+  // History for the moves which follow a given previous move
+  class Slice {
+  public:
+    inline int operator[](const PieceSquare key) const { return tab_[key.index()]; }
+
+    inline void update(const PieceSquare key, const int bonus) {
+      updateHistory(tab_[key.index()], bonus);
+    }
+
+    inline void age() { ageHistory(tab_, PieceSquare::INDEX_COUNT); }
+
+  private:
+    int16_t tab_[PieceSquare::INDEX_COUNT] = {};
+  };
+
+  ContinuationHistory() : tab_(std::make_unique<Slice[]>(PieceSquare::INDEX_COUNT)) {}
+
+  inline Slice &operator[](const PieceSquare prev) { return tab_[prev.index()]; }
+  inline const Slice &operator[](const PieceSquare prev) const { return tab_[prev.index()]; }
+
+  inline void age() {
+    for (size_t i = 0; i < PieceSquare::INDEX_COUNT; ++i) {
+      tab_[i].age();
+    }
   }
 
-  // Returns `true` if `board` is present in the hash table
-  inline bool has(const SoFCore::board_hash_t board) const {
-    const size_t idx = board & mask_;
-    for (size_t i = 0; i < BUCKET_SIZE; ++i) {
-      if (tab_[idx + i] == board) {
-        return true;
-      }
+private:
+  std::unique_ptr<Slice[]> tab_;
+};
+
+// Capture history, i.e. the history of captures indexed by moved piece, destination cell and
+// captured piece
+class CaptureHistory {
+public:
+  CaptureHistory() : tab_(std::make_unique<int16_t[]>(TAB_SIZE)) {
+    std::fill(tab_.get(), tab_.get() + TAB_SIZE, 0);
+  }
+
+  inline int get(const PieceSquare key, const SoFCore::cell_t captured) const {
+    return tab_[indexOf(key, captured)];
+  }
+
+  inline void update(const PieceSquare key, const SoFCore::cell_t captured, const int bonus) {
+    updateHistory(tab_[indexOf(key, captured)], bonus);
+  }
+
+  inline void age() { ageHistory(tab_.get(), TAB_SIZE); }
+
+private:
+  inline constexpr static size_t indexOf(const PieceSquare key, const SoFCore::cell_t captured) {
+    return (key.index() << 4) | static_cast<size_t>(captured);
+  }
+
+  std::unique_ptr<int16_t[]> tab_;
+
+  static constexpr size_t TAB_SIZE = PieceSquare::INDEX_COUNT * 16;
+};
+
+// Table of counter moves, i.e. the quiet moves which caused beta cutoff in response to a given
+// previous move
+class CounterMoveTable {
+public:
+  CounterMoveTable() : tab_(std::make_unique<SoFCore::Move[]>(PieceSquare::INDEX_COUNT)) {
+    std::fill(tab_.get(), tab_.get() + PieceSquare::INDEX_COUNT, SoFCore::Move::null());
+  }
+
+  inline SoFCore::Move &operator[](const PieceSquare prev) { return tab_[prev.index()]; }
+  inline SoFCore::Move operator[](const PieceSquare prev) const { return tab_[prev.index()]; }
+
+private:
+  std::unique_ptr<SoFCore::Move[]> tab_;
+};
+
+// Move ordering tables of a single search job. They persist between the searches in the same game,
+// so the next search starts with the statistics collected by the previous ones
+struct OrderingTables {
+  HistoryTable history;
+  CaptureHistory captures;
+  ContinuationHistory continuations;
+  CounterMoveTable counterMoves;
+  std::vector<KillerLine> killers;  // Indexed by distance from root
+  size_t rootPly = 0;                // Game ply of the root in the last search
+
+  // Prepares the tables for the next search in the same game, with the root at game ply `newPly`.
+  // The history values are aged. The killers are shifted by the number of plies the game has
+  // advanced since the last search. If it hasn't advanced (e.g. after a ponder miss or a takeback),
+  // the killers don't correspond to the new root, so they are cleared
+  inline void age(const size_t newPly) {
+    history.age();
+    captures.age();
+    continuations.age();
+    if (newPly > rootPly) {
+      killers.erase(killers.begin(),
+                    killers.begin() + std::min<size_t>(killers.size(), newPly - rootPly));
+    } else {
+      killers.clear();
     }
-    return false;
+    rootPly = newPly;
   }
+};
+
+// Returns the number of plies made from the start of the game to reach the position `board`
+inline size_t gamePly(const SoFCore::Board &board) {
+  const size_t moveNumber = std::max<size_t>(board.moveNumber, 1);
+  return 2 * (moveNumber - 1) + (board.side == SoFCore::Color::Black ? 1 : 0);
+}
 
-  // Inserts `board` into the hash table. Returns `false` if `board` is already present
-  inline bool insert(const SoFCore::board_hash_t board) {
-    if (has(board)) {
-      return false;
+// Hashes of the positions from the start of the game up to the current node, used to detect draws
+// by repetition. The positions are pushed and popped as the search goes deeper and returns back, so
+// the history is indexed by ply
+class HashHistory {
+public:
+  // Appends the position `board` to the history. `afterNullMove` must be `true` if the position was
+  // reached by a null move, as repetitions cannot span over it. Returns `true` if the position is a
+  // draw by repetition, i.e. it repeats a position after the root, or the position before the root
+  // which occurred twice
+  inline bool push(const SoFCore::Board &board, const bool afterNullMove) {
+    const size_t size = entries_.size();
+    Entry entry{board.hash, 0, false};
+    if (!afterNullMove && size != 0) {
+      entry.reversible = std::min<uint16_t>(board.moveCounter, entries_.back().reversible + 1);
     }
-    for (;;) {
-      const size_t idx = board & mask_;
-      for (size_t i = 0; i < BUCKET_SIZE; ++i) {
-        if (SOF_LIKELY(tab_[idx + i] == 0)) {
-          tab_[idx + i] = board;
-          return true;
-        }
+    bool isDraw = false;
+    // Only the positions with the same side to move and without irreversible moves between them
+    // may repeat
+    for (size_t i = 4; i <= entry.reversible; i += 2) {
+      const Entry &prev = entries_[size - i];
+      if (prev.hash == board.hash) {
+        entry.repeated = true;
+        isDraw = (size - i >= root_ || prev.repeated);
+        break;
       }
-      grow();
     }
+    entries_.push_back(entry);
+    return isDraw;
   }
 
-  // Removes `board` from the hash table. If it's not present, the behavior is undefined
-  inline void erase(const SoFCore::board_hash_t board) {
-    const size_t idx = board & mask_;
-    for (size_t i = 0; i < BUCKET_SIZE; ++i) {
-      uint64_t &val = tab_[idx + i];
-      if (val == board) {
-        val = 0;
-        return;
+  // Removes the last position from the history
+  inline void pop() { entries_.pop_back(); }
+
+  // Marks the next position to be pushed as the root of the search
+  inline void markRoot() { root_ = entries_.size(); }
+
+  // Reserves the space for `count` more positions
+  inline void reserve(const size_t count) { entries_.reserve(entries_.size() + count); }
+
+  // Returns `true` if the side to move can make a reversible move which leads to a draw by
+  // repetition, so the position is at least a draw for it. `board` must be the last pushed
+  // position.
+  //
+  // The moves are found with cuckoo tables without generating them, see "Efficient detection of
+  // repeated positions" by Marcel van Kervinck for details
+  inline bool hasUpcomingRepetition(const SoFCore::Board &board) const {
+    const size_t last = entries_.size() - 1;
+    const size_t reversible = entries_[last].reversible;
+    for (size_t i = 3; i <= reversible; i += 2) {
+      const Entry &prev = entries_[last - i];
+      if ((last - i >= root_ || prev.repeated) &&
+          SoFCore::hasReversibleMove(board, board.hash ^ prev.hash)) {
+        return true;
       }
     }
+    return false;
   }
 
 private:
-  void grow();
-
-  std::unique_ptr<SoFCore::board_hash_t[]> tab_;
-  size_t bucketCount_;
-  size_t mask_;  // Equal to `(bucketCount - 1) * BUCKET_SIZE`
+  struct Entry {
+    SoFCore::board_hash_t hash;
+    uint16_t reversible;  // Number of previous positions reachable only by reversible moves
+    bool repeated;        // Is the position equal to some previous position?
+  };
 
-  static constexpr size_t INITIAL_BUCKET_COUNT = 32;
-  static constexpr size_t BUCKET_SIZE = 4;
+  std::vector<Entry> entries_;
+  size_t root_ = 0;
 };
 
 }  // namespace SoFSearch::Private
@@ -1,6 +1,7 @@
 #include "search/search.h"
 
 #include <optional>
+#include <utility>
 
 #include "core/board.h"
 #include "core/move.h"
@@ -15,6 +16,7 @@ namespace SoFSearch {
 using namespace std::chrono_literals;
 using namespace SoFUtil::Logging;
 
+using Private::ParallelMode;
 using Private::Position;
 using Private::SearchLimits;
 using SoFBotApi::ApiResult;
@@ -30,6 +32,7 @@ struct Engine::Impl {
   std::optional<Private::JobRunner> runner;
   Position position = Position::from(Board::initialPosition(), {});
   std::vector<Move> moves;
+  bool ponderNext = false;  // Start the next search in ponder mode?
 };
 
 ApiResult Engine::connect(SoFBotApi::Server *server) {
@@ -56,11 +59,23 @@ SoFBotApi::OptionStorage Engine::makeOptions(Engine *engine) {
   return SoFBotApi::OptionBuilder(engine)
       .addInt("Hash", 1, Private::TranspositionTable::DEFAULT_SIZE >> 20, 131'072)
       .addInt("Threads", 1, 1, 512)
+      .addInt("Move Overhead", 0, 30, 5000)
+      .addInt("MultiPV", 1, 1, 256)
+      .addBool("Ponder", false)
+      // The order of items must match the order of `ParallelMode` members
+      .addEnum("Parallel search", {"Lazy SMP", "Young brothers wait"}, 0)
+      // The order of items must match the order of `ThreadBinding` members
+      .addEnum("Thread binding", {"None", "NUMA nodes", "Cores"}, 0)
+      // The order of items must match the order of `InternalIterativeMode` members
+      .addEnum("Internal iterative search", {"None", "Deepening", "Reductions"}, 0)
       .addAction("Clear hash")
       .options();
 }
 
-ApiResult Engine::newGame() { return ApiResult::Ok; }
+ApiResult Engine::newGame() {
+  p_->runner->newGame();
+  return ApiResult::Ok;
+}
 
 void Engine::enterDebugMode() { p_->runner->setDebugMode(true); }
 
@@ -72,7 +87,15 @@ ApiResult Engine::reportError(const char *message) {
 }
 
 ApiResult Engine::doSearch(const Private::SearchLimits &limits) {
-  p_->runner->start(p_->position, limits, options_.getInt("Threads")->value);
+  Private::JobRunnerParams params;
+  params.numJobs = options_.getInt("Threads")->value;
+  params.parallelMode = static_cast<ParallelMode>(options_.getEnum("Parallel search")->index);
+  params.threadBinding =
+      static_cast<Private::ThreadBinding>(options_.getEnum("Thread binding")->index);
+  params.internalIterativeMode = static_cast<Private::InternalIterativeMode>(
+      options_.getEnum("Internal iterative search")->index);
+  params.multiPv = options_.getInt("MultiPV")->value;
+  p_->runner->start(p_->position, limits, params, std::exchange(p_->ponderNext, false));
   return ApiResult::Ok;
 }
 
@@ -86,12 +109,21 @@ ApiResult Engine::searchFixedNodes(uint64_t nodes) {
   return doSearch(SearchLimits::withFixedNodes(nodes));
 }
 
+ApiResult Engine::searchMate(size_t moves) {
+  if (moves == 0) {
+    p_->ponderNext = false;
+    return ApiResult::InvalidArgument;
+  }
+  return doSearch(SearchLimits::withMate(moves));
+}
+
 ApiResult Engine::searchFixedTime(std::chrono::milliseconds time) {
   return doSearch(SearchLimits::withFixedTime(time));
 }
 
 ApiResult Engine::searchTimeControl(const TimeControl &control) {
-  return doSearch(SearchLimits::withTimeControl(p_->position.last, control));
+  const std::chrono::milliseconds moveOverhead(options_.getInt("Move Overhead")->value);
+  return doSearch(SearchLimits::withTimeControl(p_->position.last, control, moveOverhead));
 }
 
 ApiResult Engine::setPosition(const SoFCore::Board &board, const SoFCore::Move *moves,
@@ -100,6 +132,15 @@ ApiResult Engine::setPosition(const SoFCore::Board &board, const SoFCore::Move *
   return ApiResult::Ok;
 }
 
+ApiResult Engine::enablePonder() {
+  p_->ponderNext = true;
+  return ApiResult::Ok;
+}
+
+ApiResult Engine::ponderHit() {
+  return p_->runner->ponderHit() ? ApiResult::Ok : ApiResult::UnexpectedCall;
+}
+
 ApiResult Engine::stopSearch() {
   p_->runner->stop();
   return ApiResult::Ok;
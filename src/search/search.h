@@ -33,9 +33,13 @@ public:
   SoFBotApi::ApiResult searchInfinite() override;
   SoFBotApi::ApiResult searchFixedDepth(size_t depth) override;
   SoFBotApi::ApiResult searchFixedNodes(uint64_t nodes) override;
+  SoFBotApi::ApiResult searchMate(size_t moves) override;
   SoFBotApi::ApiResult searchFixedTime(std::chrono::milliseconds time) override;
   SoFBotApi::ApiResult searchTimeControl(const SoFBotApi::TimeControl &control) override;
 
+  SoFBotApi::ApiResult enablePonder() override;
+  SoFBotApi::ApiResult ponderHit() override;
+
   SoFBotApi::ApiResult stopSearch() override;
   SoFBotApi::ApiResult reportError(const char *message) override;
 
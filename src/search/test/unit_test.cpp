@@ -1,9 +1,22 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <condition_variable>
 #include <limits>
+#include <mutex>
+#include <vector>
 
+#include "bot_api/server.h"
+#include "core/board.h"
+#include "core/init.h"
+#include "core/move_parser.h"
+#include "search/private/evaluate.h"
+#include "search/private/job_runner.h"
+#include "search/private/limits.h"
 #include "search/private/score.h"
+#include "search/private/see.h"
+#include "search/private/types.h"
+#include "search/private/util.h"
 
 TEST(SoFSearch, ScorePair) {
   using namespace SoFSearch::Private;
@@ -49,3 +62,342 @@ TEST(SoFSearch, ScorePair) {
     }
   }
 }
+
+TEST(SoFSearch, StaticExchange) {
+  using namespace SoFSearch::Private;
+  using SoFCore::Board;
+
+  SoFCore::init();
+
+  struct TestCase {
+    const char *fen;
+    const char *move;
+    score_t see;
+  };
+
+  static constexpr TestCase TEST_CASES[] = {
+      // Pawn takes undefended pawn
+      {"4k3/8/8/3p4/4P3/8/8/4K3 w - - 0 1", "e4d5", 100},
+      // Queen takes pawn defended by pawn
+      {"4k3/8/2p5/3p4/8/8/8/3QK3 w - - 0 1", "d1d5", -900},
+      // Rooks take knight defended by rook, second rook attacks via x-ray
+      {"3rk3/8/8/3n4/8/8/3R4/3RK3 w - - 0 1", "d2d5", 350},
+      // Quiet bishop move to the cell not attacked by enemy
+      {"4k3/8/2p5/3n4/8/8/8/4KB2 w - - 0 1", "f1c4", 0},
+      // Bishop takes knight defended by pawn
+      {"4k3/8/2p5/3n4/8/1B6/8/4K3 w - - 0 1", "b3d5", 0},
+      // Quiet move to the cell attacked by pawn
+      {"4k3/8/2p5/8/8/8/8/3QK3 w - - 0 1", "d1d5", -1000},
+      // Enpassant
+      {"4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1", "e5d6", 100},
+      // King recaptures only if the cell is not defended
+      {"4k3/8/8/8/8/8/3q4/3RK3 b - - 0 1", "d2d1", -475},
+      {"3rk3/8/8/8/8/8/3q4/3RK3 b - - 0 1", "d2d1", 525},
+  };
+
+  for (const TestCase &test : TEST_CASES) {
+    const Board board = Board::fromFen(test.fen).unwrap();
+    const SoFCore::Move move = SoFCore::moveParse(test.move, board);
+    EXPECT_TRUE(isSeeAtLeast(board, move, test.see)) << test.fen << " " << test.move;
+    EXPECT_FALSE(isSeeAtLeast(board, move, test.see + 1)) << test.fen << " " << test.move;
+  }
+}
+
+TEST(SoFSearch, TimeControlLimits) {
+  using namespace SoFSearch::Private;
+  using namespace std::chrono_literals;
+
+  SoFCore::init();
+
+  const SoFCore::Board board = SoFCore::Board::initialPosition();
+  SoFBotApi::TimeControl control;
+  control.white.time = 10s;
+  control.black.time = 10s;
+
+  // Zero moves to go is invalid, but some servers send it. It must be treated as one move
+  control.movesToGo = 0;
+  const SearchLimits zeroLimits = SearchLimits::withTimeControl(board, control, 0ms);
+  control.movesToGo = 1;
+  const SearchLimits oneLimits = SearchLimits::withTimeControl(board, control, 0ms);
+  EXPECT_EQ(zeroLimits.time, oneLimits.time);
+  EXPECT_EQ(zeroLimits.softTime, oneLimits.softTime);
+  EXPECT_LE(zeroLimits.time, 10s);
+  EXPECT_LE(zeroLimits.softTime, zeroLimits.time);
+}
+
+TEST(SoFSearch, KillerAging) {
+  using namespace SoFSearch::Private;
+  using SoFCore::Board;
+
+  SoFCore::init();
+
+  Board board = Board::initialPosition();
+  EXPECT_EQ(gamePly(board), 0);
+  const SoFCore::Move killer = SoFCore::moveParse("g1f3", board);
+  for (const char *move : {"e2e4", "e7e5"}) {
+    SoFCore::moveMake(board, SoFCore::moveParse(move, board));
+  }
+  EXPECT_EQ(gamePly(board), 2);
+  EXPECT_EQ(gamePly(Board::fromFen("4k3/8/8/8/8/8/8/4K3 b - - 0 10").unwrap()), 19);
+
+  // The killers move closer to the root as the game advances
+  OrderingTables tables;
+  tables.killers.resize(8);
+  tables.killers[2].add(killer);
+  tables.age(gamePly(board));
+  ASSERT_EQ(tables.killers.size(), 6);
+  EXPECT_EQ(tables.killers[0].first(), killer);
+
+  // If the root didn't advance, the killers are cleared
+  tables.age(gamePly(board));
+  EXPECT_TRUE(tables.killers.empty());
+}
+
+TEST(SoFSearch, HashHistory) {
+  using namespace SoFSearch::Private;
+  using SoFCore::Board;
+  using SoFCore::Move;
+
+  SoFCore::init();
+
+  struct Results {
+    std::vector<bool> draws;     // Results of `push()` for each position after the root
+    std::vector<bool> upcoming;  // Results of `hasUpcomingRepetition()` for the same positions
+  };
+
+  // Plays the moves `before` from the initial position to get the root, and then plays the moves
+  // `after` from the root, as the search does. "0000" denotes null move
+  auto replay = [](const std::vector<const char *> &before,
+                   const std::vector<const char *> &after) {
+    Board board = Board::initialPosition();
+    std::vector<Move> moves;
+    for (const char *str : before) {
+      const Move move = SoFCore::moveParse(str, board);
+      moves.push_back(move);
+      SoFCore::moveMake(board, move);
+    }
+    const Position position = Position::from(Board::initialPosition(), moves);
+    HashHistory hashes = position.hashes;
+    board = position.last;
+    hashes.push(board, false);
+    Results results;
+    for (const char *str : after) {
+      const Move move = SoFCore::moveParse(str, board);
+      SoFCore::moveMake(board, move);
+      results.draws.push_back(hashes.push(board, move == Move::null()));
+      results.upcoming.push_back(hashes.hasUpcomingRepetition(board));
+    }
+    return results;
+  };
+
+  const std::vector<const char *> shuffle = {"g1f3", "g8f6", "f3g1", "f6g8"};
+  const std::vector<const char *> twoShuffles = {"g1f3", "g8f6", "f3g1", "f6g8",
+                                                 "g1f3", "g8f6", "f3g1", "f6g8"};
+
+  // Repetition of the position after the root is a draw, while the position occurred only once
+  // before the root is not
+  Results results = replay(shuffle, shuffle);
+  EXPECT_EQ(results.draws, (std::vector<bool>{false, false, false, true}));
+  EXPECT_EQ(results.upcoming, (std::vector<bool>{false, false, true, true}));
+
+  // The position which occurred twice before the root is a draw on the third occurrence
+  results = replay(twoShuffles, {"g1f3"});
+  EXPECT_EQ(results.draws, (std::vector<bool>{true}));
+
+  // The repetition cycle crosses the root
+  results = replay({"g1f3", "g8f6"}, {"f3g1", "f6g8", "g1f3", "g8f6"});
+  EXPECT_EQ(results.draws, (std::vector<bool>{false, false, false, true}));
+  EXPECT_EQ(results.upcoming, (std::vector<bool>{false, false, true, true}));
+
+  // The positions before a pawn move cannot repeat, so only the ones after it are considered
+  results = replay({}, {"g1f3", "g8f6", "e2e3", "f6g8", "f3g1", "g8f6", "g1f3"});
+  EXPECT_EQ(results.draws, (std::vector<bool>{false, false, false, false, false, false, true}));
+  EXPECT_EQ(results.upcoming, (std::vector<bool>{false, false, false, false, false, true, true}));
+
+  // The positions before a null move are not considered, so the initial position doesn't repeat.
+  // But the position reached by the null move repeats later
+  results = replay({}, {"g1f3", "0000", "f3g1", "g8f6", "0000", "f6g8", "g1f3", "g8f6", "f3g1",
+                        "f6g8"});
+  EXPECT_EQ(results.draws, (std::vector<bool>{false, false, false, false, false, false, false,
+                                              false, true, true}));
+  EXPECT_EQ(results.upcoming, (std::vector<bool>{false, false, false, false, false, false, false,
+                                                 true, true, true}));
+}
+
+TEST(SoFSearch, PsqScoreUpdate) {
+  using namespace SoFSearch::Private;
+  using SoFCore::Board;
+
+  SoFCore::init();
+
+  struct TestCase {
+    const char *fen;
+    const char *move;
+    int phase;  // Phase after the move
+  };
+
+  static constexpr TestCase TEST_CASES[] = {
+      // Quiet move
+      {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", "g1f3", 24},
+      // Captures
+      {"rnbqkbnr/ppp1pppp/8/3p4/4P3/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 2", "e4d5", 24},
+      {"rnb1kbnr/pppppppp/8/8/3q4/5N2/PPPPPPPP/RNBQKB1R w KQkq - 0 1", "f3d4", 20},
+      {"rnb1kbnr/pppppppp/8/8/3q4/2N5/PPPPPPPP/R1BQKBNR b KQkq - 0 1", "d4c3", 23},
+      // Enpassant
+      {"4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1", "e5d6", 0},
+      // Castling
+      {"r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1", "e1g1", 8},
+      {"r3k2r/8/8/8/8/8/8/R3K2R b KQkq - 0 1", "e8c8", 8},
+      // Promotions
+      {"4k3/1P6/8/8/8/8/8/4K3 w - - 0 1", "b7b8q", 4},
+      {"4k3/1P6/8/8/8/8/8/4K3 w - - 0 1", "b7b8n", 1},
+      {"4k3/8/8/8/8/8/6p1/4K3 b - - 0 1", "g2g1r", 2},
+      // Capture-promotions
+      {"r3k3/1P6/8/8/8/8/8/4K3 w - - 0 1", "b7a8q", 4},
+      {"4k3/8/8/8/8/8/6p1/4KB1R b - - 0 1", "g2h1b", 2},
+      // The phase exceeds its initial value after promotion
+      {"rnbqkb2/ppppppPp/8/8/8/8/PPPPPP1P/RNBQKBNR w KQq - 0 1", "g7g8q", 25},
+  };
+
+  for (const TestCase &test : TEST_CASES) {
+    Board board = Board::fromFen(test.fen).unwrap();
+    const SoFCore::Move move = SoFCore::moveParse(test.move, board);
+    const PsqScore updated = boardUpdatePsqScore(board, move, boardGetPsqScore(board));
+    SoFCore::moveMake(board, move);
+    const PsqScore expected = boardGetPsqScore(board);
+    EXPECT_EQ(updated.score, expected.score) << test.fen << " " << test.move;
+    EXPECT_EQ(updated.phase, expected.phase) << test.fen << " " << test.move;
+    EXPECT_EQ(updated.phase, test.phase) << test.fen << " " << test.move;
+  }
+}
+
+TEST(SoFSearch, TaperedEvaluation) {
+  using namespace SoFSearch::Private;
+  using SoFCore::Board;
+
+  SoFCore::init();
+
+  const Board board = Board::initialPosition();
+  const Board pawnEnding = Board::fromFen("4k3/pppp4/8/8/8/8/4PPPP/4K3 w - - 0 1").unwrap();
+  EXPECT_EQ(boardGetPsqScore(board).phase, PHASE_MAX);
+  EXPECT_EQ(boardGetPsqScore(pawnEnding).phase, 0);
+
+  const score_pair_t score = makeScorePair(120, -60);
+  // Only the middlegame score is used with full phase, and only the endgame score with zero phase
+  EXPECT_EQ(evaluate(board, PsqScore{score, PHASE_MAX}), 120);
+  EXPECT_EQ(evaluate(board, PsqScore{score, 0}), -60);
+  EXPECT_EQ(evaluate(board, PsqScore{score, PHASE_MAX / 2}), 30);
+  // After promotions, the phase may exceed its maximum, but the score is still the middlegame one
+  EXPECT_EQ(evaluate(board, PsqScore{score, PHASE_MAX + 4}), 120);
+}
+
+// Server which remembers the results of the search and allows to wait until the search is finished
+class RecordingServer : public SoFBotApi::Server {
+public:
+  SoFBotApi::ApiResult finishSearch(const SoFCore::Move bestMove, SoFCore::Move) override {
+    std::unique_lock lock(lock_);
+    bestMove_ = bestMove;
+    isFinished_ = true;
+    finished_.notify_all();
+    return SoFBotApi::ApiResult::Ok;
+  }
+
+  SoFBotApi::ApiResult sendResult(const SoFBotApi::SearchResult &result) override {
+    std::unique_lock lock(lock_);
+    if (result.bound == SoFBotApi::PositionCostBound::Exact) {
+      depth_ = result.depth;
+      cost_ = result.cost;
+    }
+    return SoFBotApi::ApiResult::Ok;
+  }
+
+  SoFBotApi::ApiResult sendString(const char *) override { return SoFBotApi::ApiResult::Ok; }
+  SoFBotApi::ApiResult sendNodeCount(uint64_t) override { return SoFBotApi::ApiResult::Ok; }
+  SoFBotApi::ApiResult sendHashHits(uint64_t) override { return SoFBotApi::ApiResult::Ok; }
+  SoFBotApi::ApiResult sendHashFull(SoFBotApi::permille_t) override {
+    return SoFBotApi::ApiResult::Ok;
+  }
+  SoFBotApi::ApiResult sendCurrMove(SoFCore::Move, size_t) override {
+    return SoFBotApi::ApiResult::Ok;
+  }
+  SoFBotApi::ApiResult reportError(const char *) override { return SoFBotApi::ApiResult::Ok; }
+
+  // Waits until the search is finished
+  void wait() {
+    std::unique_lock lock(lock_);
+    finished_.wait(lock, [&]() { return isFinished_; });
+    isFinished_ = false;
+  }
+
+  SoFCore::Move bestMove() const { return bestMove_; }
+  size_t depth() const { return depth_; }
+  SoFBotApi::PositionCost cost() const { return cost_; }
+
+protected:
+  SoFBotApi::ApiResult connect(SoFBotApi::Client *) override { return SoFBotApi::ApiResult::Ok; }
+  void disconnect() override {}
+
+private:
+  std::mutex lock_;
+  std::condition_variable finished_;
+  bool isFinished_ = false;
+  SoFCore::Move bestMove_ = SoFCore::Move::null();
+  size_t depth_ = 0;
+  SoFBotApi::PositionCost cost_;
+};
+
+TEST(SoFSearch, YoungBrothersWait) {
+  using namespace SoFSearch::Private;
+  using SoFCore::Board;
+
+  SoFCore::init();
+
+  struct TestCase {
+    const char *fen;
+    const char *bestMove;  // `nullptr` if the best move is not unique
+  };
+
+  static constexpr TestCase TEST_CASES[] = {
+      // Back rank mate
+      {"6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1", "d1d8"},
+      // Undefended queen
+      {"4k3/8/8/8/3q4/8/4N3/4K3 w - - 0 1", "e2d4"},
+      // Quiet middlegame position
+      {"r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4", nullptr},
+  };
+
+  static constexpr size_t DEPTH = 8;
+
+  RecordingServer server;
+  JobRunner runner(server);
+  for (const TestCase &test : TEST_CASES) {
+    const Board board = Board::fromFen(test.fen).unwrap();
+    const Position position = Position::from(board, {});
+    SoFCore::Move bestMoves[2];
+    SoFBotApi::PositionCost costs[2];
+    const ParallelMode modes[2] = {ParallelMode::LazySmp, ParallelMode::YoungBrothersWait};
+    for (size_t i = 0; i < 2; ++i) {
+      JobRunnerParams params;
+      params.numJobs = 4;
+      params.parallelMode = modes[i];
+      runner.hashClear();
+      runner.newGame();
+      runner.start(position, SearchLimits::withFixedDepth(DEPTH), params, false);
+      server.wait();
+      runner.join();
+      EXPECT_EQ(server.depth(), DEPTH) << test.fen;
+      bestMoves[i] = server.bestMove();
+      costs[i] = server.cost();
+    }
+    // Both modes must find the same best move if it's unique
+    for (const SoFCore::Move move : bestMoves) {
+      ASSERT_TRUE(SoFCore::isMoveValid(board, move)) << test.fen;
+      if (test.bestMove) {
+        EXPECT_EQ(move, SoFCore::moveParse(test.bestMove, board)) << test.fen;
+      }
+    }
+    if (test.bestMove) {
+      EXPECT_EQ(costs[0], costs[1]) << test.fen;
+    }
+  }
+}
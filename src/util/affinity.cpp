@@ -0,0 +1,126 @@
+#include "util/affinity.h"
+
+#include "config.h"
+
+#ifdef USE_THREAD_AFFINITY
+#include <pthread.h>
+#include <sched.h>
+
+#include <fstream>
+#include <string>
+
+#include "util/strutil.h"
+#endif
+
+namespace SoFUtil {
+
+#ifdef USE_THREAD_AFFINITY
+
+// Parses the list in the format used by Linux kernel in sysfs (e.g. "0-3,8,10-11"). Returns
+// `false` if the list is malformed
+static bool parseSysfsList(const std::string &str, std::vector<size_t> &result) {
+  result.clear();
+  const char *cur = str.c_str();
+  const char *end = cur + str.size();
+  while (cur != end && *cur != '\n') {
+    const char *itemEnd = cur;
+    while (itemEnd != end && *itemEnd != ',' && *itemEnd != '\n') {
+      ++itemEnd;
+    }
+    const char *dash = cur;
+    while (dash != itemEnd && *dash != '-') {
+      ++dash;
+    }
+    size_t first = 0;
+    size_t last = 0;
+    if (!valueFromStr(cur, dash, first)) {
+      return false;
+    }
+    if (dash == itemEnd) {
+      last = first;
+    } else if (!valueFromStr(dash + 1, itemEnd, last)) {
+      return false;
+    }
+    for (size_t i = first; i <= last; ++i) {
+      result.push_back(i);
+    }
+    cur = (itemEnd != end && *itemEnd == ',') ? itemEnd + 1 : itemEnd;
+  }
+  return true;
+}
+
+// Reads the first line of the file `path` and parses it as the list described above
+static bool readSysfsList(const std::string &path, std::vector<size_t> &result) {
+  std::ifstream in(path);
+  std::string line;
+  if (!in || !std::getline(in, line)) {
+    return false;
+  }
+  return parseSysfsList(line, result);
+}
+
+std::vector<std::vector<size_t>> cpuNumaNodes() {
+  cpu_set_t available;
+  CPU_ZERO(&available);
+  if (sched_getaffinity(0, sizeof(available), &available) != 0) {
+    return {};
+  }
+  auto isAvailable = [&](const size_t cpu) {
+    return cpu < CPU_SETSIZE && CPU_ISSET(cpu, &available);
+  };
+
+  std::vector<std::vector<size_t>> result;
+  std::vector<size_t> nodes;
+  if (readSysfsList("/sys/devices/system/node/online", nodes)) {
+    for (const size_t node : nodes) {
+      std::vector<size_t> cpus;
+      if (!readSysfsList("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist",
+                         cpus)) {
+        continue;
+      }
+      std::vector<size_t> nodeCpus;
+      for (const size_t cpu : cpus) {
+        if (isAvailable(cpu)) {
+          nodeCpus.push_back(cpu);
+        }
+      }
+      if (!nodeCpus.empty()) {
+        result.push_back(std::move(nodeCpus));
+      }
+    }
+  }
+  if (result.empty()) {
+    // Unable to detect NUMA topology, so assume that all the CPUs belong to one node
+    std::vector<size_t> cpus;
+    for (size_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (isAvailable(cpu)) {
+        cpus.push_back(cpu);
+      }
+    }
+    if (!cpus.empty()) {
+      result.push_back(std::move(cpus));
+    }
+  }
+  return result;
+}
+
+bool threadBindToCpus(const std::vector<size_t> &cpus) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (const size_t cpu : cpus) {
+    if (cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &set);
+    }
+  }
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+#else
+
+std::vector<std::vector<size_t>> cpuNumaNodes() { return {}; }
+
+bool threadBindToCpus(const std::vector<size_t> &) { return false; }
+
+#endif
+
+}  // namespace SoFUtil
@@ -0,0 +1,24 @@
+#ifndef SOF_UTIL_AFFINITY_INCLUDED
+#define SOF_UTIL_AFFINITY_INCLUDED
+
+#include <cstddef>
+#include <vector>
+
+namespace SoFUtil {
+
+// Returns the logical CPUs available to the current process, grouped by NUMA nodes. The nodes
+// without available CPUs are omitted. If the NUMA topology cannot be detected, all the available
+// CPUs are returned as a single node. If thread affinity is not supported on the current platform,
+// or no CPUs are available, returns an empty list.
+std::vector<std::vector<size_t>> cpuNumaNodes();
+
+// Restricts the current thread to run only on the logical CPUs from `cpus`. Returns `true` on
+// success. If thread affinity is not supported on the current platform, always returns `false`.
+//
+// Note that the memory is usually allocated on the NUMA node on which it was first touched, so it's
+// recommended to call this function before the thread allocates its data.
+bool threadBindToCpus(const std::vector<size_t> &cpus);
+
+}  // namespace SoFUtil
+
+#endif  // SOF_UTIL_AFFINITY_INCLUDED